@@ -0,0 +1,173 @@
+#include "decoders.h"
+
+#include <numeric>
+
+
+// Messages of all frames are interleaved: value of edge (or node) x for lane k is stored at [x * K + k],
+// so the innermost loops run over frames and vectorize. Lanes [0, active) hold frames still being decoded;
+// a converged frame is replaced by the last active one, which keeps the active lanes contiguous.
+std::vector<BatchDecodingResult> decode_nms_to_syndrome_batch(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, std::vector<std::vector<LLR>> const& Rs, std::vector<Eigen::VectorX<GF2>> const& ss, double scale, size_t max_iters)
+{
+	if (Rs.size() != ss.size()) {
+		throw std::runtime_error{"Batch decoder: numbers of LLR vectors and syndromes differ"};
+	}
+
+	if (!H.isCompressed()) {
+		Eigen::SparseMatrix<GF2, Eigen::RowMajor> H_compressed{H};
+		H_compressed.makeCompressed();
+		return decode_nms_to_syndrome_batch(H_compressed, Rs, ss, scale, max_iters);
+	}
+
+	size_t const K{Rs.size()};
+	size_t const m = H.rows();
+	size_t const n = H.cols();
+	size_t const nnz = H.nonZeros();
+	int const * outer_index_ptr = H.outerIndexPtr();
+	int const * inner_index_ptr = H.innerIndexPtr();
+
+	std::vector<BatchDecodingResult> results(K);
+	if (!K) {
+		return results;
+	}
+
+	std::vector<double> R(n * K);
+	std::vector<unsigned char> s(m * K);
+	std::vector<double> M(nnz * K);
+	std::vector<double> E(nnz * K);
+	std::vector<double> L(n * K);
+	std::vector<unsigned char> c(n * K);
+
+	// Row state for all lanes
+	std::vector<double> min_1(K);
+	std::vector<double> min_2(K);
+	std::vector<size_t> min_1_pos(K);
+	std::vector<unsigned char> sign(K);
+	std::vector<unsigned char> unsatisfied(K);
+
+	std::vector<size_t> lane_frame(K);
+	std::iota(lane_frame.begin(), lane_frame.end(), 0);
+
+	for (size_t k{0}; k < K; ++k) {
+		if (Rs[k].size() != n || static_cast<size_t>(ss[k].size()) != m) {
+			throw std::runtime_error{"Batch decoder: frame size incompatible with H"};
+		}
+		for (size_t i{0}; i < n; ++i) {
+			R[i * K + k] = Rs[k][i];
+		}
+		for (size_t j{0}; j < m; ++j) {
+			s[j * K + k] = static_cast<bool>(ss[k][j]);
+		}
+	}
+
+	for (size_t e{0}; e < nnz; ++e) {
+		std::copy_n(R.begin() + inner_index_ptr[e] * K, K, M.begin() + e * K);
+	}
+
+	size_t active{K};
+	size_t I{0};
+	while (active) {
+
+		for (size_t j{0}; j < m; ++j) {
+			std::fill_n(min_1.begin(), active, std::numeric_limits<double>::max());
+			std::fill_n(min_2.begin(), active, std::numeric_limits<double>::max());
+			std::fill_n(min_1_pos.begin(), active, static_cast<size_t>(outer_index_ptr[j]));
+			std::copy_n(s.begin() + j * K, active, sign.begin());
+
+			for (size_t e = outer_index_ptr[j]; e < static_cast<size_t>(outer_index_ptr[j + 1]); ++e) {
+				double const * M_edge = M.data() + e * K;
+				for (size_t k{0}; k < active; ++k) {
+					double beta{std::abs(M_edge[k])};
+					sign[k] ^= M_edge[k] < 0;
+					min_2[k] = std::min(min_2[k], std::max(min_1[k], beta));
+					min_1_pos[k] = beta < min_1[k] ? e : min_1_pos[k];
+					min_1[k] = std::min(min_1[k], beta);
+				}
+			}
+
+			for (size_t e = outer_index_ptr[j]; e < static_cast<size_t>(outer_index_ptr[j + 1]); ++e) {
+				double const * M_edge = M.data() + e * K;
+				double * E_edge = E.data() + e * K;
+				for (size_t k{0}; k < active; ++k) {
+					double val{(min_1_pos[k] == e ? min_2[k] : min_1[k]) * scale};
+					E_edge[k] = (sign[k] ^ (M_edge[k] < 0)) ? -val : val;
+				}
+			}
+		}
+
+		// Same summation order as in decode_nms_to_syndrome_r: rows ascending, channel LLR last
+		for (size_t i{0}; i < n; ++i) {
+			std::fill_n(L.begin() + i * K, active, 0.0);
+		}
+		for (size_t e{0}; e < nnz; ++e) {
+			double const * E_edge = E.data() + e * K;
+			double * L_var = L.data() + inner_index_ptr[e] * K;
+			for (size_t k{0}; k < active; ++k) {
+				L_var[k] += E_edge[k];
+			}
+		}
+		for (size_t i{0}; i < n; ++i) {
+			for (size_t k{0}; k < active; ++k) {
+				L[i * K + k] += R[i * K + k];
+				c[i * K + k] = L[i * K + k] < 0; // Hard decision
+			}
+		}
+
+		std::fill_n(unsatisfied.begin(), active, 0);
+		for (size_t j{0}; j < m; ++j) {
+			std::copy_n(s.begin() + j * K, active, sign.begin());
+			for (size_t e = outer_index_ptr[j]; e < static_cast<size_t>(outer_index_ptr[j + 1]); ++e) {
+				unsigned char const * c_var = c.data() + inner_index_ptr[e] * K;
+				for (size_t k{0}; k < active; ++k) {
+					sign[k] ^= c_var[k];
+				}
+			}
+			for (size_t k{0}; k < active; ++k) {
+				unsatisfied[k] |= sign[k];
+			}
+		}
+
+		for (size_t e{0}; e < nnz; ++e) {
+			double * M_edge = M.data() + e * K;
+			double const * E_edge = E.data() + e * K;
+			double const * L_var = L.data() + inner_index_ptr[e] * K;
+			for (size_t k{0}; k < active; ++k) {
+				M_edge[k] = L_var[k] - E_edge[k];
+			}
+		}
+
+		// Retire finished frames. Lanes are scanned backwards, so the lane moved in has already been checked.
+		for (size_t k{active}; k-- > 0; ) {
+			if (unsatisfied[k] && I != max_iters) {
+				continue;
+			}
+
+			BatchDecodingResult & res = results[lane_frame[k]];
+			res.word.resize(n);
+			for (size_t i{0}; i < n; ++i) {
+				res.word[i] = GF2{c[i * K + k] != 0};
+			}
+			res.iterations = I + 1;
+			res.syndrome_matches = !unsatisfied[k];
+
+			size_t last{active - 1};
+			if (k != last) {
+				for (size_t e{0}; e < nnz; ++e) {
+					M[e * K + k] = M[e * K + last];
+				}
+				for (size_t i{0}; i < n; ++i) {
+					R[i * K + k] = R[i * K + last];
+				}
+				for (size_t j{0}; j < m; ++j) {
+					s[j * K + k] = s[j * K + last];
+				}
+				lane_frame[k] = lane_frame[last];
+				unsatisfied[k] = unsatisfied[last];
+			}
+			--active;
+		}
+
+		++I;
+	}
+
+	return results;
+}
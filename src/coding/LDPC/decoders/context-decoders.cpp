@@ -0,0 +1,881 @@
+#include "decoders.h"
+#include "context-kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+
+namespace
+{
+
+bool syndrome_bit(Eigen::VectorX<GF2> const& s, size_t j) { return static_cast<bool>(s[j]); }
+bool syndrome_bit(BitVector const& s, size_t j) { return s.get(j); }
+
+
+// Syndrome is Eigen::VectorX<GF2> or BitVector; null s means zero syndrome
+template <typename Syndrome>
+void load_frame(DecoderContext const& ctx, DecoderScratch & sc, std::vector<LLR> const& R, Syndrome const* s)
+{
+	if (R.size() != ctx.cols() || (s && static_cast<size_t>(s->size()) != ctx.rows())) {
+		throw std::runtime_error{"Frame size incompatible with decoder context"};
+	}
+	bool same_frame{true}; // Messages left by another frame must not be resumed
+	for (size_t i{0}; i < ctx.cols(); ++i) {
+		same_frame &= sc.R[i] == R[i];
+		sc.R[i] = R[i];
+	}
+	for (size_t j{0}; j < ctx.rows(); ++j) {
+		unsigned char bit = s ? syndrome_bit(*s, j) : 0;
+		same_frame &= sc.s[j] == bit;
+		sc.s[j] = bit;
+	}
+	if (!same_frame) {
+		sc.resumable.reset();
+	}
+	sc.syndrome.reset(ctx.rows(), ctx.cols(), sc.s);
+}
+
+
+void set_hard_decision(DecoderContext const& ctx, DecoderScratch & sc, size_t i, bool bit)
+{
+	sc.syndrome.set(i, bit, [&ctx](size_t i, auto f) { ctx.for_each_row_of(i, f); });
+}
+
+
+// L = R + column sums of E, hard decision into the syndrome tracker
+template <typename T = double>
+void posteriors(DecoderContext const& ctx, DecoderScratch & sc)
+{
+	std::vector<uint32_t> const& edge_col{ctx.edge_col()};
+	MessageBuffers<T> buffers{message_buffers<T>(sc)};
+	std::fill(buffers.L.begin(), buffers.L.end(), T{0});
+	for (size_t e{0}; e < ctx.non_zeros(); ++e) {
+		buffers.L[edge_col[e]] += buffers.E[e];
+	}
+	for (size_t i{0}; i < ctx.cols(); ++i) {
+		buffers.L[i] += buffers.R[i];
+		set_hard_decision(ctx, sc, i, buffers.L[i] < 0);
+	}
+}
+
+
+// Warm start: posteriors and variable-to-check messages from the check-to-variable messages left in E by the
+// previous decoding of the same frame on this scratch
+template <typename T = double>
+void resume_messages(DecoderContext const& ctx, DecoderScratch & sc)
+{
+	MessageBuffers<T> buffers{message_buffers<T>(sc)};
+	if (buffers.E.size() != ctx.non_zeros()) {
+		throw std::runtime_error{"Warm start needs the messages of a previous decoding"};
+	}
+	std::vector<uint32_t> const& edge_col{ctx.edge_col()};
+	posteriors<T>(ctx, sc);
+	buffers.M.resize(ctx.non_zeros());
+	for (size_t e{0}; e < ctx.non_zeros(); ++e) {
+		buffers.M[e] = buffers.L[edge_col[e]] - buffers.E[e];
+	}
+}
+
+
+void check_output(DecoderContext const& ctx, size_t out_size)
+{
+	if (out_size != ctx.cols()) {
+		throw std::runtime_error{"Output buffer size incompatible with decoder context"};
+	}
+}
+
+
+void write_output(DecoderScratch const& sc, std::span<GF2> out)
+{
+	std::vector<unsigned char> const& bits{sc.syndrome.bits()};
+	for (size_t i{0}; i < bits.size(); ++i) {
+		out[i] = static_cast<bool>(bits[i]);
+	}
+}
+
+
+void write_output(DecoderScratch const& sc, BitVector & out)
+{
+	std::vector<unsigned char> const& bits{sc.syndrome.bits()};
+	std::span<uint64_t> words{out.words()};
+	for (size_t k{0}; k < words.size(); ++k) {
+		uint64_t word{0};
+		size_t const i_end{std::min(bits.size(), 64 * k + 64)};
+		for (size_t i{64 * k}; i < i_end; ++i) {
+			word |= uint64_t{bits[i]} << (i & 63);
+		}
+		words[k] = word;
+	}
+}
+
+
+// Trace policies of the decoding engine. NoTrace compiles to nothing; StreamTrace writes the iteration number and
+// the hard decision with its number of unsatisfied checks once per iteration, or once per layer for layered schedules.
+struct NoTrace
+{
+	void iteration(size_t) {}
+	void layer(size_t, size_t, size_t) {}
+	void hard_decision(SyndromeTracker const&) {}
+};
+
+
+struct StreamTrace
+{
+	std::ostream & os;
+
+	void iteration(size_t I) { os << "Iteration " << I << ":\n"; }
+	void layer(size_t layer, size_t row_begin, size_t row_end) { os << "Layer " << layer << ", rows from " << row_begin << " to " << row_end - 1 << ":\n"; }
+	void hard_decision(SyndromeTracker const& syndrome)
+	{
+		os << "Hard decision: ";
+		for (unsigned char bit : syndrome.bits()) {
+			os << static_cast<int>(bit) << " ";
+		}
+		os << "(unsatisfied checks: " << syndrome.unsatisfied() << ")" << std::endl;
+	}
+};
+
+
+// Early abort of DecoderParams::stall_window, fed once per iteration. The lowest number of unsatisfied checks seen
+// so far not improving for window iterations covers both a frozen hard decision and one oscillating around a trapping set.
+class StallDetector
+{
+public:
+	explicit StallDetector(size_t window) : m_window{window} {}
+
+	bool stalled(SyndromeTracker const& syndrome)
+	{
+		if (m_window == 0) {
+			return false;
+		}
+		if (syndrome.unsatisfied() < m_best) {
+			m_best = syndrome.unsatisfied();
+			m_since_best = 0;
+			return false;
+		}
+		return ++m_since_best >= m_window;
+	}
+
+private:
+	size_t m_window;
+	size_t m_best{std::numeric_limits<size_t>::max()};
+	size_t m_since_best{0};
+};
+
+
+// check_nodes(row_begin, row_end, iteration) computes E from M for a range of rows
+template <typename T = double, typename CheckNodes, typename Trace>
+DecodingStats decode_flooding(DecoderContext const& ctx, DecoderScratch & sc, CheckNodes const& check_nodes, size_t max_iters, bool warm_start, StallDetector & stall, Trace & trace)
+{
+	std::vector<uint32_t> const& edge_col{ctx.edge_col()};
+	MessageBuffers<T> buffers{message_buffers<T>(sc)};
+	if (warm_start) {
+		resume_messages<T>(ctx, sc);
+	}
+	else {
+		buffers.M.resize(ctx.non_zeros());
+		buffers.E.resize(ctx.non_zeros());
+		for (size_t e{0}; e < ctx.non_zeros(); ++e) {
+			buffers.M[e] = buffers.R[edge_col[e]];
+		}
+	}
+
+	for (size_t I{0}; ; ++I) {
+		trace.iteration(I);
+		check_nodes(size_t{0}, ctx.rows(), I);
+
+		posteriors<T>(ctx, sc);
+		trace.hard_decision(sc.syndrome);
+		bool converged{sc.syndrome.satisfied()};
+		if (I == max_iters || converged) {
+			return {converged, I + 1};
+		}
+		if (stall.stalled(sc.syndrome)) {
+			return {false, I + 1, true};
+		}
+
+		for (size_t e{0}; e < ctx.non_zeros(); ++e) {
+			buffers.M[e] = buffers.L[edge_col[e]] - buffers.E[e];
+		}
+	}
+}
+
+
+// Layers of layer_size consecutive rows are processed in turn (the last one may be shorter); scratch L holds
+// the running belief, E the check-to-variable messages of all rows and M the messages of the current layer.
+// Within a layer rows are updated from the same belief, so rows sharing a variable behave as in flooding.
+// Only bits of the current layer can flip their hard decision, so only they are passed to the syndrome tracker.
+template <typename T = double, typename CheckNodes, typename Trace>
+DecodingStats decode_layered(DecoderContext const& ctx, DecoderScratch & sc, CheckNodes const& check_nodes, size_t layer_size, size_t max_iters, bool warm_start, StallDetector & stall, Trace & trace)
+{
+	if (layer_size == 0) {
+		throw std::runtime_error{"Layer size incompatible"};
+	}
+	size_t layers_number{(ctx.rows() + layer_size - 1) / layer_size};
+
+	std::vector<uint32_t> const& row_ptr{ctx.row_ptr()};
+	std::vector<uint32_t> const& edge_col{ctx.edge_col()};
+	MessageBuffers<T> buffers{message_buffers<T>(sc)};
+	if (warm_start) {
+		resume_messages<T>(ctx, sc);
+	}
+	else {
+		buffers.M.resize(ctx.non_zeros());
+		buffers.E.assign(ctx.non_zeros(), T{0});
+		std::copy(buffers.R.begin(), buffers.R.end(), buffers.L.begin());
+		for (size_t i{0}; i < ctx.cols(); ++i) {
+			set_hard_decision(ctx, sc, i, buffers.L[i] < 0);
+		}
+	}
+
+	for (size_t I{0}; ; ++I) {
+		trace.iteration(I);
+		for (size_t layer{0}; layer < layers_number; ++layer) {
+			size_t row_begin{layer * layer_size};
+			size_t row_end{std::min(row_begin + layer_size, ctx.rows())};
+			uint32_t e_begin{row_ptr[row_begin]};
+			uint32_t e_end{row_ptr[row_end]};
+			trace.layer(layer, row_begin, row_end);
+
+			for (uint32_t e{e_begin}; e < e_end; ++e) {
+				buffers.M[e] = buffers.L[edge_col[e]] - buffers.E[e];
+			}
+			for (uint32_t e{e_begin}; e < e_end; ++e) {
+				buffers.L[edge_col[e]] -= buffers.E[e];
+			}
+			check_nodes(row_begin, row_end, I);
+			for (uint32_t e{e_begin}; e < e_end; ++e) {
+				buffers.L[edge_col[e]] += buffers.E[e];
+			}
+
+			for (uint32_t e{e_begin}; e < e_end; ++e) {
+				set_hard_decision(ctx, sc, edge_col[e], buffers.L[edge_col[e]] < 0);
+			}
+			trace.hard_decision(sc.syndrome);
+
+			bool converged{sc.syndrome.satisfied()};
+			if (I == max_iters || converged) {
+				return {converged, I + 1};
+			}
+		}
+		if (stall.stalled(sc.syndrome)) {
+			return {false, I + 1, true};
+		}
+	}
+}
+
+
+// Check rules of the shuffled schedule keep running aggregates of every row's variable-to-check messages:
+// reset() rebuilds them from M, message() gives the check-to-variable message on an edge from them and
+// update() replaces a variable-to-check message, keeping the aggregates of its row current.
+
+// Aggregates are the two smallest |M| (uncorrected) and the sign parity. A row is rescanned only when the message
+// holding one of its minima grows past min_2; ties may leave another min_1_pos than a full scan, with the same messages.
+template <DecodingMode MODE, typename Correction>
+struct ShuffledMinSum
+{
+	Correction correction;
+
+	void rescan(DecoderContext const& ctx, DecoderScratch & sc, size_t j) const
+	{
+		uint32_t row_begin{ctx.row_ptr()[j]};
+		RowMins mins{row_mins_by_degree(sc.M.data() + row_begin, ctx.row_degrees()[j])};
+		CompressedCheckNode & node{sc.check_nodes[j]};
+		node.min_1 = mins.min_1;
+		node.min_2 = mins.min_2;
+		node.min_1_pos = row_begin + mins.min_1_pos;
+	}
+
+	void reset(DecoderContext const& ctx, DecoderScratch & sc) const
+	{
+		sc.check_nodes.resize(ctx.rows());
+		for (size_t j{0}; j < ctx.rows(); ++j) {
+			RowMins mins{row_mins_by_degree(sc.M.data() + ctx.row_ptr()[j], ctx.row_degrees()[j])};
+			sc.check_nodes[j] = {mins.min_1, mins.min_2, ctx.row_ptr()[j] + mins.min_1_pos, mins.sign != target_parity<MODE>(sc, j)};
+		}
+	}
+
+	double message(DecoderContext const& ctx, DecoderScratch const& sc, size_t j, uint32_t e, size_t iteration) const
+	{
+		CompressedCheckNode const& node{sc.check_nodes[j]};
+		double val{correction.apply(e == node.min_1_pos ? node.min_2 : node.min_1, iteration, ctx.row_degrees()[j])};
+		return (node.sign != (sc.M[e] < 0)) ? -val : val;
+	}
+
+	void update(DecoderContext const& ctx, DecoderScratch & sc, size_t j, uint32_t e, double M) const
+	{
+		CompressedCheckNode & node{sc.check_nodes[j]};
+		double old_beta{std::abs(sc.M[e])};
+		double beta{std::abs(M)};
+		node.sign ^= (sc.M[e] < 0) != (M < 0);
+		sc.M[e] = M;
+		if (e == node.min_1_pos) {
+			if (beta <= node.min_2) {
+				node.min_1 = beta;
+			}
+			else {
+				rescan(ctx, sc, j);
+			}
+		}
+		else if (beta < node.min_1) {
+			node.min_2 = node.min_1;
+			node.min_1 = beta;
+			node.min_1_pos = e;
+		}
+		else if (beta <= node.min_2) {
+			node.min_2 = beta;
+		}
+		else if (old_beta == node.min_2) {
+			rescan(ctx, sc, j);
+		}
+	}
+};
+
+
+// Aggregates are the row sums of phi(|M|) and the sign parity; sums are rebuilt every iteration, so rounding
+// of the incremental updates does not accumulate.
+template <DecodingMode MODE>
+struct ShuffledSumProduct
+{
+	void reset(DecoderContext const& ctx, DecoderScratch & sc) const
+	{
+		std::vector<uint32_t> const& row_ptr{ctx.row_ptr()};
+		sc.phi_M.resize(ctx.non_zeros());
+		sc.phi_sums.resize(ctx.rows());
+		sc.row_signs.resize(ctx.rows());
+		for (size_t j{0}; j < ctx.rows(); ++j) {
+			double phi_sum{0.0};
+			bool sign{target_parity<MODE>(sc, j)};
+			for (uint32_t e{row_ptr[j]}; e < row_ptr[j + 1]; ++e) {
+				sc.phi_M[e] = phi_clamped(std::abs(sc.M[e]));
+				phi_sum += sc.phi_M[e];
+				sign ^= sc.M[e] < 0;
+			}
+			sc.phi_sums[j] = phi_sum;
+			sc.row_signs[j] = sign;
+		}
+	}
+
+	double message(DecoderContext const&, DecoderScratch const& sc, size_t j, uint32_t e, size_t) const
+	{
+		double val{phi_clamped(sc.phi_sums[j] - sc.phi_M[e])};
+		return (static_cast<bool>(sc.row_signs[j]) != (sc.M[e] < 0)) ? -val : val;
+	}
+
+	void update(DecoderContext const&, DecoderScratch & sc, size_t j, uint32_t e, double M) const
+	{
+		double phi_new{phi_clamped(std::abs(M))};
+		sc.phi_sums[j] += phi_new - sc.phi_M[e];
+		sc.phi_M[e] = phi_new;
+		sc.row_signs[j] ^= (sc.M[e] < 0) != (M < 0);
+		sc.M[e] = M;
+	}
+};
+
+
+// Shuffled (column-serial) schedule: columns are processed in consecutive groups of group_size (the last one may be
+// shorter). The check-to-variable messages of a group are computed from the current variable-to-check messages of
+// their rows, so a group already sees the updates made by the groups before it in the same iteration. Within a group
+// all messages come from the same state, so with group_size >= cols() the schedule reduces to flooding.
+template <typename ShuffledRule, typename Trace>
+DecodingStats decode_shuffled(DecoderContext const& ctx, DecoderScratch & sc, ShuffledRule const& rule, size_t group_size, size_t max_iters, bool warm_start, StallDetector & stall, Trace & trace)
+{
+	if (group_size == 0) {
+		throw std::runtime_error{"Group size incompatible"};
+	}
+
+	std::vector<uint32_t> const& col_ptr{ctx.col_ptr()};
+	std::vector<uint32_t> const& col_edges{ctx.col_edges()};
+	std::vector<uint32_t> const& edge_row{ctx.edge_row()};
+	std::vector<uint32_t> const& edge_col{ctx.edge_col()};
+	if (warm_start) {
+		resume_messages(ctx, sc);
+	}
+	else {
+		sc.M.resize(ctx.non_zeros());
+		sc.E.resize(ctx.non_zeros());
+		for (size_t e{0}; e < ctx.non_zeros(); ++e) {
+			sc.M[e] = sc.R[edge_col[e]];
+		}
+	}
+
+	for (size_t I{0}; ; ++I) {
+		trace.iteration(I);
+		rule.reset(ctx, sc);
+		for (size_t col_begin{0}; col_begin < ctx.cols(); col_begin += group_size) {
+			size_t col_end{std::min(col_begin + group_size, ctx.cols())};
+
+			for (uint32_t p{col_ptr[col_begin]}; p < col_ptr[col_end]; ++p) {
+				uint32_t e{col_edges[p]};
+				sc.E[e] = rule.message(ctx, sc, edge_row[e], e, I);
+			}
+			// Column sums in CSC order add E in the same order as posteriors(), so L matches flooding bit for bit
+			for (size_t i{col_begin}; i < col_end; ++i) {
+				double L{0.0};
+				for (uint32_t p{col_ptr[i]}; p < col_ptr[i + 1]; ++p) {
+					L += sc.E[col_edges[p]];
+				}
+				L += sc.R[i];
+				sc.L[i] = L;
+				set_hard_decision(ctx, sc, i, L < 0);
+				for (uint32_t p{col_ptr[i]}; p < col_ptr[i + 1]; ++p) {
+					uint32_t e{col_edges[p]};
+					rule.update(ctx, sc, edge_row[e], e, L - sc.E[e]);
+				}
+			}
+
+			bool converged{sc.syndrome.satisfied()};
+			if (I == max_iters || converged) {
+				trace.hard_decision(sc.syndrome);
+				return {converged, I + 1};
+			}
+		}
+		trace.hard_decision(sc.syndrome);
+		if (stall.stalled(sc.syndrome)) {
+			return {false, I + 1, true};
+		}
+	}
+}
+
+
+// Residual (node-wise informed dynamic) schedule: E holds candidate messages computed from the current M, E_applied
+// the messages already added to the posteriors, and the residual of a row is its largest |E - E_applied|. The row with
+// the largest residual is committed: its candidates go into L, the other rows of its variables get new M and candidates.
+// Work is counted in row recomputes, the check node updates a flooding iteration does rows() of: the budget is
+// (max_iters + 1) * rows() of them, the initial pass over all rows included, and reported iterations are recomputes
+// divided by rows(), rounded up. Decoding also stops when all residuals are zero, since no commit can change anything then.
+template <typename CheckNodes, typename Trace>
+DecodingStats decode_residual(DecoderContext const& ctx, DecoderScratch & sc, CheckNodes const& check_nodes, size_t max_iters, bool warm_start, StallDetector & stall, Trace & trace)
+{
+	std::vector<uint32_t> const& row_ptr{ctx.row_ptr()};
+	std::vector<uint32_t> const& edge_col{ctx.edge_col()};
+	std::vector<uint32_t> const& edge_row{ctx.edge_row()};
+	std::vector<uint32_t> const& col_ptr{ctx.col_ptr()};
+	std::vector<uint32_t> const& col_edges{ctx.col_edges()};
+	sc.row_stamps.assign(ctx.rows(), 0);
+	sc.residuals.reset(ctx.rows());
+	if (warm_start) {
+		resume_messages(ctx, sc);
+		sc.E_applied.assign(sc.E.begin(), sc.E.end());
+	}
+	else {
+		sc.M.resize(ctx.non_zeros());
+		sc.E.resize(ctx.non_zeros());
+		sc.E_applied.assign(ctx.non_zeros(), 0.0);
+		for (size_t e{0}; e < ctx.non_zeros(); ++e) {
+			sc.M[e] = sc.R[edge_col[e]];
+		}
+		std::copy(sc.R.begin(), sc.R.end(), sc.L.begin());
+		for (size_t i{0}; i < ctx.cols(); ++i) {
+			set_hard_decision(ctx, sc, i, sc.L[i] < 0);
+		}
+	}
+
+	size_t const rows{std::max<size_t>(ctx.rows(), 1)};
+	size_t const budget{(max_iters + 1) * rows};
+	size_t updates{0};
+	auto recompute = [&](size_t j) {
+		check_nodes(j, j + 1, updates / rows);
+		++updates;
+		double residual{0.0};
+		for (uint32_t e{row_ptr[j]}; e < row_ptr[j + 1]; ++e) {
+			residual = std::max(residual, std::abs(sc.E[e] - sc.E_applied[e]));
+		}
+		sc.residuals.update(static_cast<uint32_t>(j), residual);
+	};
+
+	trace.iteration(0);
+	for (size_t j{0}; j < ctx.rows(); ++j) {
+		recompute(j);
+	}
+
+	size_t iteration{0}; // Of the last trace and stall check
+	for (size_t commit{1}; ; ++commit) {
+		bool converged{sc.syndrome.satisfied()};
+		if (converged || updates >= budget || ctx.rows() == 0 || sc.residuals.top_priority() == 0.0) {
+			trace.hard_decision(sc.syndrome);
+			return {converged, (updates + rows - 1) / rows};
+		}
+
+		uint32_t j{sc.residuals.top()};
+		sc.row_stamps[j] = commit;
+		for (uint32_t e{row_ptr[j]}; e < row_ptr[j + 1]; ++e) {
+			uint32_t i{edge_col[e]};
+			sc.L[i] += sc.E[e] - sc.E_applied[e];
+			sc.E_applied[e] = sc.E[e];
+			set_hard_decision(ctx, sc, i, sc.L[i] < 0);
+		}
+		sc.residuals.update(j, 0.0);
+
+		// Messages of the committed row's variables to their other rows change; M into row j itself does not
+		for (uint32_t e{row_ptr[j]}; e < row_ptr[j + 1]; ++e) {
+			uint32_t i{edge_col[e]};
+			for (uint32_t p{col_ptr[i]}; p < col_ptr[i + 1]; ++p) {
+				uint32_t f{col_edges[p]};
+				if (edge_row[f] != j) {
+					sc.M[f] = sc.L[i] - sc.E_applied[f];
+				}
+			}
+		}
+		for (uint32_t e{row_ptr[j]}; e < row_ptr[j + 1] && updates < budget; ++e) {
+			uint32_t i{edge_col[e]};
+			for (uint32_t p{col_ptr[i]}; p < col_ptr[i + 1] && updates < budget; ++p) {
+				uint32_t k{edge_row[col_edges[p]]};
+				if (sc.row_stamps[k] != commit) {
+					sc.row_stamps[k] = commit;
+					recompute(k);
+				}
+			}
+		}
+
+		if (updates / rows != iteration && updates / rows < max_iters) { // Like flooding, not after the last iteration
+			trace.hard_decision(sc.syndrome);
+			if (!sc.syndrome.satisfied() && stall.stalled(sc.syndrome)) {
+				return {false, (updates + rows - 1) / rows, true};
+			}
+			iteration = updates / rows;
+			trace.iteration(iteration);
+		}
+	}
+}
+
+
+// Shuffled and residual schedules, which keep double messages only
+template <DecodingMode MODE, typename Trace>
+DecodingStats decode_sequential(DecoderContext const& ctx, DecoderScratch & sc, LDPC_algo alg_type, DecoderParams const& params, StallDetector & stall, Trace & trace)
+{
+	switch (alg_type) {
+		case LDPC_algo::RSP:
+			return decode_residual(ctx, sc, [&ctx, &sc](size_t row_begin, size_t row_end, size_t) {
+				sum_product_check_nodes<MODE>(ctx, sc, row_begin, row_end);
+			}, params.max_iters, params.warm_start, stall, trace);
+		case LDPC_algo::RNMS:
+			return with_correction(make_min_sum_rule(alg_type, params), [&](auto const& correction) {
+				return decode_residual(ctx, sc, [&ctx, &sc, &correction](size_t row_begin, size_t row_end, size_t I) {
+					min_sum_check_nodes<MODE>(ctx, sc, row_begin, row_end, correction, I);
+				}, params.max_iters, params.warm_start, stall, trace);
+			});
+		case LDPC_algo::SSP:
+			return decode_shuffled(ctx, sc, ShuffledSumProduct<MODE>{}, params.group_size, params.max_iters, params.warm_start, stall, trace);
+		case LDPC_algo::SNMS:
+			return with_correction(make_min_sum_rule(alg_type, params), [&](auto const& correction) {
+				return decode_shuffled(ctx, sc, ShuffledMinSum<MODE, std::decay_t<decltype(correction)>>{correction}, params.group_size, params.max_iters, params.warm_start, stall, trace);
+			});
+		default:
+			throw std::runtime_error{"Invalid LDPC algorithm"};
+	}
+}
+
+
+// Every (schedule, check node rule, mode, message type, trace) combination is a separate instantiation, so the hot
+// loops carry neither the algorithm switch nor trace branches; the runtime choice is made once per frame below.
+template <DecodingMode MODE, typename T, typename Trace>
+DecodingStats decode_frame(DecoderContext const& ctx, DecoderScratch & sc, LDPC_algo alg_type, DecoderParams const& params, Trace & trace)
+{
+	StallDetector stall{params.stall_window};
+	switch (alg_type) {
+		case LDPC_algo::SP:
+			return decode_flooding<T>(ctx, sc, [&ctx, &sc](size_t row_begin, size_t row_end, size_t) {
+				sum_product_check_nodes<MODE, T>(ctx, sc, row_begin, row_end);
+			}, params.max_iters, params.warm_start, stall, trace);
+		case LDPC_algo::MS:
+		case LDPC_algo::NMS:
+		case LDPC_algo::OMS:
+			return with_correction(make_min_sum_rule(alg_type, params), [&](auto const& correction) {
+				return decode_flooding<T>(ctx, sc, [&ctx, &sc, &correction](size_t row_begin, size_t row_end, size_t I) {
+					min_sum_check_nodes<MODE, T>(ctx, sc, row_begin, row_end, correction, I);
+				}, params.max_iters, params.warm_start, stall, trace);
+			});
+		case LDPC_algo::LMS:
+		case LDPC_algo::LNMS:
+		case LDPC_algo::LOMS:
+			return with_correction(make_min_sum_rule(alg_type, params), [&](auto const& correction) {
+				return decode_layered<T>(ctx, sc, [&ctx, &sc, &correction](size_t row_begin, size_t row_end, size_t I) {
+					min_sum_check_nodes<MODE, T>(ctx, sc, row_begin, row_end, correction, I);
+				}, params.layer_size, params.max_iters, params.warm_start, stall, trace);
+			});
+		default:
+			if constexpr (std::is_same_v<T, double>) {
+				return decode_sequential<MODE>(ctx, sc, alg_type, params, stall, trace);
+			}
+			else {
+				throw std::runtime_error{"Float messages are supported by the flooding and layered algorithms only"};
+			}
+	}
+}
+
+
+template <typename Trace>
+DecodingStats decode_frame(DecoderContext const& ctx, DecoderScratch & sc, LDPC_algo alg_type, DecoderParams const& params, bool to_syndrome, Trace & trace)
+{
+	if (params.precision == MessagePrecision::FLOAT) {
+		sc.R_float.assign(sc.R.begin(), sc.R.end());
+		sc.L_float.resize(ctx.cols());
+		if (to_syndrome) {
+			return decode_frame<DecodingMode::SYNDROME, float>(ctx, sc, alg_type, params, trace);
+		}
+		return decode_frame<DecodingMode::CODEWORD, float>(ctx, sc, alg_type, params, trace);
+	}
+	if (to_syndrome) {
+		return decode_frame<DecodingMode::SYNDROME, double>(ctx, sc, alg_type, params, trace);
+	}
+	return decode_frame<DecodingMode::CODEWORD, double>(ctx, sc, alg_type, params, trace);
+}
+
+
+DecodingStats decode_frame(DecoderContext const& ctx, DecoderScratch & sc, LDPC_algo alg_type, DecoderParams const& params, bool to_syndrome)
+{
+	if (params.warm_start && sc.resumable != params.precision) {
+		throw std::runtime_error{"Warm start needs the messages of a previous decoding of the frame with the same precision"};
+	}
+	sc.resumable.reset();
+	DecodingStats stats;
+	if (params.trace) {
+		StreamTrace trace{*params.trace};
+		stats = decode_frame(ctx, sc, alg_type, params, to_syndrome, trace);
+	}
+	else {
+		NoTrace trace;
+		stats = decode_frame(ctx, sc, alg_type, params, to_syndrome, trace);
+	}
+	sc.resumable = params.precision;
+	return stats;
+}
+
+
+double correct_min(double min, MinSumCorrection correction, double correction_value)
+{
+	return correction == MinSumCorrection::NORMALIZED ? min * correction_value : std::max(min - correction_value, 0.0);
+}
+
+
+bool sign_bit(std::vector<uint64_t> const& bits, uint32_t e)
+{
+	return (bits[e >> 6] >> (e & 63)) & 1;
+}
+
+
+void set_sign_bit(std::vector<uint64_t> & bits, uint32_t e, bool value)
+{
+	uint64_t mask{uint64_t{1} << (e & 63)};
+	bits[e >> 6] = value ? (bits[e >> 6] | mask) : (bits[e >> 6] & ~mask);
+}
+
+
+double compressed_message(CompressedCheckNode const& node, std::vector<uint64_t> const& M_signs, uint32_t e)
+{
+	double val{e == node.min_1_pos ? node.min_2 : node.min_1};
+	return (node.sign != sign_bit(M_signs, e)) ? -val : val;
+}
+
+
+// Flooding min-sum where check-to-variable messages live only as CompressedCheckNode rows plus sign bits of
+// variable-to-check messages. Variable-to-check messages are recomputed from the previous posteriors when a row
+// is processed, and the new posteriors are accumulated in L_next.
+DecodingStats decode_compressed(DecoderContext const& ctx, DecoderScratch & sc, MinSumCorrection correction, double correction_value, size_t max_iters)
+{
+	std::vector<uint32_t> const& row_ptr{ctx.row_ptr()};
+	std::vector<uint32_t> const& edge_col{ctx.edge_col()};
+	sc.L_next.resize(ctx.cols());
+	sc.M_signs.assign((ctx.non_zeros() + 63) / 64, 0);
+	sc.check_nodes.assign(ctx.rows(), {0.0, 0.0, 0, false}); // Zero messages make the first M equal to R
+	std::copy(sc.R.begin(), sc.R.end(), sc.L.begin());
+
+	for (size_t I{0}; ; ++I) {
+		std::fill(sc.L_next.begin(), sc.L_next.end(), 0.0);
+		for (size_t j{0}; j < ctx.rows(); ++j) {
+			CompressedCheckNode & node{sc.check_nodes[j]};
+			double min_1{std::numeric_limits<double>::max()};
+			double min_2{std::numeric_limits<double>::max()};
+			uint32_t min_1_pos{row_ptr[j]};
+			bool sign{static_cast<bool>(sc.s[j])};
+			for (uint32_t e{row_ptr[j]}; e < row_ptr[j + 1]; ++e) {
+				double M{sc.L[edge_col[e]] - compressed_message(node, sc.M_signs, e)};
+				double beta{std::abs(M)};
+				if (beta < min_1) {
+					min_2 = min_1;
+					min_1 = beta;
+					min_1_pos = e;
+				}
+				else if (beta < min_2) {
+					min_2 = beta;
+				}
+				sign ^= M < 0;
+				set_sign_bit(sc.M_signs, e, M < 0);
+			}
+			node = {correct_min(min_1, correction, correction_value), correct_min(min_2, correction, correction_value), min_1_pos, sign};
+			for (uint32_t e{row_ptr[j]}; e < row_ptr[j + 1]; ++e) {
+				sc.L_next[edge_col[e]] += compressed_message(node, sc.M_signs, e);
+			}
+		}
+
+		for (size_t i{0}; i < ctx.cols(); ++i) {
+			sc.L_next[i] += sc.R[i];
+			set_hard_decision(ctx, sc, i, sc.L_next[i] < 0);
+		}
+		std::swap(sc.L, sc.L_next);
+
+		bool converged{sc.syndrome.satisfied()};
+		if (I == max_iters || converged) {
+			return {converged, I + 1};
+		}
+	}
+}
+
+
+template <typename Syndrome, typename Output>
+DecodingStats decode_with_context(DecoderContext const& ctx, size_t thread_index, LDPC_algo alg_type, std::vector<LLR> const& R, Syndrome const* s, Output & out, DecoderParams const& params)
+{
+	check_output(ctx, out.size());
+	DecoderScratch & sc{ctx.scratch(thread_index)};
+	load_frame(ctx, sc, R, s);
+	DecodingStats stats{decode_frame(ctx, sc, alg_type, params, s != nullptr)};
+	stats.unsatisfied = sc.syndrome.unsatisfied();
+	write_output(sc, out);
+	return stats;
+}
+
+
+DecoderParams make_params(double scale, size_t layer_size, size_t max_iters)
+{
+	DecoderParams params;
+	params.scale = scale;
+	params.layer_size = layer_size;
+	params.max_iters = max_iters;
+	return params;
+}
+
+}
+
+
+DecodingStats decode_to_syndrome_into(DecoderContext const& ctx, size_t thread_index, LDPC_algo alg_type, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, std::span<GF2> out, DecoderParams const& params)
+{
+	return decode_with_context(ctx, thread_index, alg_type, R, &s, out, params);
+}
+
+
+DecodingStats decode_to_syndrome_into(DecoderContext const& ctx, size_t thread_index, LDPC_algo alg_type, std::vector<LLR> const& R, BitVector const& s, BitVector & out, DecoderParams const& params)
+{
+	return decode_with_context(ctx, thread_index, alg_type, R, &s, out, params);
+}
+
+
+DecodingStats decode_into(DecoderContext const& ctx, size_t thread_index, LDPC_algo alg_type, std::vector<LLR> const& R, std::span<GF2> out, DecoderParams const& params)
+{
+	return decode_with_context(ctx, thread_index, alg_type, R, static_cast<Eigen::VectorX<GF2> const*>(nullptr), out, params);
+}
+
+
+Eigen::VectorX<GF2> decode_to_syndrome(DecoderContext const& ctx, size_t thread_index, LDPC_algo alg_type, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, DecoderParams const& params)
+{
+	Eigen::VectorX<GF2> c(ctx.cols());
+	decode_to_syndrome_into(ctx, thread_index, alg_type, R, s, {c.data(), ctx.cols()}, params);
+	return c;
+}
+
+
+Eigen::VectorX<GF2> decode(DecoderContext const& ctx, size_t thread_index, LDPC_algo alg_type, std::vector<LLR> const& R, DecoderParams const& params)
+{
+	Eigen::VectorX<GF2> c(ctx.cols());
+	decode_into(ctx, thread_index, alg_type, R, {c.data(), ctx.cols()}, params);
+	return c;
+}
+
+
+DecodingStats decode_to_syndrome_into(DecoderContext const& ctx, size_t thread_index, LDPC_algo alg_type, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, std::span<GF2> out, double scale, size_t layer_size, size_t max_iters)
+{
+	return decode_to_syndrome_into(ctx, thread_index, alg_type, R, s, out, make_params(scale, layer_size, max_iters));
+}
+
+
+DecodingStats decode_to_syndrome_into(DecoderContext const& ctx, size_t thread_index, LDPC_algo alg_type, std::vector<LLR> const& R, BitVector const& s, BitVector & out, double scale, size_t layer_size, size_t max_iters)
+{
+	return decode_to_syndrome_into(ctx, thread_index, alg_type, R, s, out, make_params(scale, layer_size, max_iters));
+}
+
+
+DecodingStats decode_into(DecoderContext const& ctx, size_t thread_index, LDPC_algo alg_type, std::vector<LLR> const& R, std::span<GF2> out, double scale, size_t layer_size, size_t max_iters)
+{
+	return decode_into(ctx, thread_index, alg_type, R, out, make_params(scale, layer_size, max_iters));
+}
+
+
+Eigen::VectorX<GF2> decode_to_syndrome(DecoderContext const& ctx, size_t thread_index, LDPC_algo alg_type, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, double scale, size_t layer_size, size_t max_iters)
+{
+	return decode_to_syndrome(ctx, thread_index, alg_type, R, s, make_params(scale, layer_size, max_iters));
+}
+
+
+Eigen::VectorX<GF2> decode(DecoderContext const& ctx, size_t thread_index, LDPC_algo alg_type, std::vector<LLR> const& R, double scale, size_t layer_size, size_t max_iters)
+{
+	return decode(ctx, thread_index, alg_type, R, make_params(scale, layer_size, max_iters));
+}
+
+
+DecodingStats decode_compressed_ms_to_syndrome_into(DecoderContext const& ctx, size_t thread_index, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, std::span<GF2> out, MinSumCorrection correction, double correction_value, size_t max_iters)
+{
+	check_output(ctx, out.size());
+	DecoderScratch & sc{ctx.scratch(thread_index)};
+	load_frame(ctx, sc, R, &s);
+	sc.resumable.reset(); // Messages stay compressed
+	DecodingStats stats{decode_compressed(ctx, sc, correction, correction_value, max_iters)};
+	stats.unsatisfied = sc.syndrome.unsatisfied();
+	write_output(sc, out);
+	return stats;
+}
+
+
+template <typename T>
+DecodingStats decode_sp_with_table(DecoderContext const& ctx, size_t thread_index, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, std::span<GF2> out, PhiTable<T> const& phi, size_t max_iters)
+{
+	check_output(ctx, out.size());
+	DecoderScratch & sc{ctx.scratch(thread_index)};
+	load_frame(ctx, sc, R, &s);
+	sc.resumable.reset();
+	StallDetector stall{0};
+	NoTrace trace;
+	DecodingStats stats{decode_flooding(ctx, sc, [&ctx, &sc, &phi](size_t row_begin, size_t row_end, size_t) { sum_product_check_nodes(ctx, sc, row_begin, row_end, phi); }, max_iters, false, stall, trace)};
+	stats.unsatisfied = sc.syndrome.unsatisfied();
+	write_output(sc, out);
+	return stats;
+}
+
+
+DecodingStats decode_sp_to_syndrome_into(DecoderContext const& ctx, size_t thread_index, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, std::span<GF2> out, PhiTable<float> const& phi, size_t max_iters)
+{
+	return decode_sp_with_table(ctx, thread_index, R, s, out, phi, max_iters);
+}
+
+
+DecodingStats decode_sp_to_syndrome_into(DecoderContext const& ctx, size_t thread_index, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, std::span<GF2> out, PhiTable<double> const& phi, size_t max_iters)
+{
+	return decode_sp_with_table(ctx, thread_index, R, s, out, phi, max_iters);
+}
+
+
+Eigen::VectorX<GF2> decode_sp_to_syndrome(DecoderContext const& ctx, size_t thread_index, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, PhiTable<float> const& phi, size_t max_iters)
+{
+	Eigen::VectorX<GF2> c(ctx.cols());
+	decode_sp_with_table(ctx, thread_index, R, s, {c.data(), ctx.cols()}, phi, max_iters);
+	return c;
+}
+
+
+Eigen::VectorX<GF2> decode_sp_to_syndrome(DecoderContext const& ctx, size_t thread_index, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, PhiTable<double> const& phi, size_t max_iters)
+{
+	Eigen::VectorX<GF2> c(ctx.cols());
+	decode_sp_with_table(ctx, thread_index, R, s, {c.data(), ctx.cols()}, phi, max_iters);
+	return c;
+}
+
+
+Eigen::VectorX<GF2> decode_compressed_ms_to_syndrome(DecoderContext const& ctx, size_t thread_index, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, MinSumCorrection correction, double correction_value, size_t max_iters)
+{
+	Eigen::VectorX<GF2> c(ctx.cols());
+	decode_compressed_ms_to_syndrome_into(ctx, thread_index, R, s, {c.data(), ctx.cols()}, correction, correction_value, max_iters);
+	return c;
+}
@@ -0,0 +1,315 @@
+#ifndef CONTEXT_KERNELS_H
+#define CONTEXT_KERNELS_H
+
+// Check node updates over a row range of a DecoderContext, shared by the serial and the parallel context decoders
+
+#include "decoder-context.h"
+#include "decoders.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+// Magnitudes are clamped before phi(x) = -log(tanh(x / 2)) so that it stays finite
+inline constexpr double PHI_MIN_ARG{1e-12};
+inline constexpr double PHI_MAX_ARG{30.0};
+
+
+inline double phi_clamped(double x)
+{
+	x = std::clamp(x, PHI_MIN_ARG, PHI_MAX_ARG);
+	return -std::log(std::tanh(x / 2.0));
+}
+
+
+inline float phi_clamped(float x)
+{
+	x = std::clamp(x, static_cast<float>(PHI_MIN_ARG), static_cast<float>(PHI_MAX_ARG));
+	return -std::log(std::tanh(x / 2.0f));
+}
+
+
+// Whether check rows are compared against a target syndrome (SYNDROME) or against zero (CODEWORD).
+// Kernels instantiated for CODEWORD do not read the syndrome at all.
+enum class DecodingMode{CODEWORD, SYNDROME};
+
+
+// Correction of min-sum check node magnitudes: min * scale (scale possibly scheduled, see DecoderParams)
+// or max(min - offset, 0). Schedules are viewed, not copied, so the rule lives no longer than its DecoderParams.
+// This is the runtime description; with_correction turns it into one of the compile-time corrections below.
+struct MinSumRule
+{
+	bool offset{false};
+	double value{1.0}; // Scale or offset
+	std::span<double const> scale_by_iteration;
+	std::span<double const> scale_by_degree;
+
+	double scale(size_t iteration, size_t degree) const
+	{
+		if (!scale_by_iteration.empty()) {
+			return scale_by_iteration[std::min(iteration, scale_by_iteration.size() - 1)];
+		}
+		return degree < scale_by_degree.size() ? scale_by_degree[degree] : value;
+	}
+};
+
+
+inline MinSumRule make_min_sum_rule(LDPC_algo alg_type, DecoderParams const& params)
+{
+	switch (alg_type) {
+		case LDPC_algo::MS:
+		case LDPC_algo::LMS:
+			return {};
+		case LDPC_algo::NMS:
+		case LDPC_algo::LNMS:
+		case LDPC_algo::SNMS:
+		case LDPC_algo::RNMS:
+			return {false, params.scale, params.scale_by_iteration, params.scale_by_degree};
+		case LDPC_algo::OMS:
+		case LDPC_algo::LOMS:
+			if (params.offset < 0.0) {
+				throw std::runtime_error{"Offset must be non-negative"};
+			}
+			{
+				MinSumRule rule;
+				rule.offset = true;
+				rule.value = params.offset;
+				return rule;
+			}
+		default:
+			throw std::runtime_error{"Invalid LDPC algorithm"};
+	}
+}
+
+
+// Compile-time min-sum corrections: apply(min, iteration, degree) gives the corrected magnitude
+struct PlainCorrection
+{
+	double apply(double min, size_t, size_t) const { return min; }
+};
+
+struct ScaleCorrection
+{
+	double scale;
+	double apply(double min, size_t, size_t) const { return min * scale; }
+};
+
+struct ScheduledScaleCorrection
+{
+	MinSumRule rule;
+	double apply(double min, size_t iteration, size_t degree) const { return min * rule.scale(iteration, degree); }
+};
+
+struct OffsetCorrection
+{
+	double offset;
+	double apply(double min, size_t, size_t) const { return std::max(min - offset, 0.0); }
+};
+
+
+// Calls f with the compile-time correction equivalent to rule and returns its result.
+// A scale of exactly 1 multiplies by nothing, so MS and NMS with scale 1 share PlainCorrection.
+template <typename F>
+decltype(auto) with_correction(MinSumRule const& rule, F && f)
+{
+	if (rule.offset) {
+		return f(OffsetCorrection{rule.value});
+	}
+	if (!rule.scale_by_iteration.empty() || !rule.scale_by_degree.empty()) {
+		return f(ScheduledScaleCorrection{rule});
+	}
+	if (rule.value == 1.0) {
+		return f(PlainCorrection{});
+	}
+	return f(ScaleCorrection{rule.value});
+}
+
+
+// Message buffers of one precision (DecoderParams::precision): the double ones of the scratch or their float counterparts
+template <typename T>
+struct MessageBuffers
+{
+	std::vector<T> & M;
+	std::vector<T> & E;
+	std::vector<T> & L;
+	std::vector<T> & R;
+};
+
+
+template <typename T>
+inline MessageBuffers<T> message_buffers(DecoderScratch & sc)
+{
+	if constexpr (std::is_same_v<T, float>) {
+		return {sc.M_float, sc.E_float, sc.L_float, sc.R_float};
+	}
+	else {
+		return {sc.M, sc.E, sc.L, sc.R};
+	}
+}
+
+
+template <DecodingMode MODE>
+inline bool target_parity(DecoderScratch const& sc, size_t j)
+{
+	if constexpr (MODE == DecodingMode::SYNDROME) {
+		return static_cast<bool>(sc.s[j]);
+	}
+	else {
+		return false;
+	}
+}
+
+
+// Two smallest magnitudes of a check row's messages, offset of the first minimum within the row
+// (first of equal ones) and parity of negative messages
+template <typename T>
+struct BasicRowMins
+{
+	T min_1;
+	T min_2;
+	uint32_t min_1_pos;
+	bool sign;
+};
+
+using RowMins = BasicRowMins<double>;
+
+
+// One message of the scan: the updates are selects rather than branches, so rows compile to straight-line code
+template <typename T>
+inline void update_row_mins(BasicRowMins<T> & mins, T message, uint32_t k)
+{
+	T beta{std::abs(message)};
+	bool lower{beta < mins.min_1};
+	mins.min_2 = lower ? mins.min_1 : std::min(mins.min_2, beta);
+	mins.min_1_pos = lower ? k : mins.min_1_pos;
+	mins.min_1 = lower ? beta : mins.min_1;
+	mins.sign ^= message < 0;
+}
+
+
+template <uint32_t D, typename T>
+inline BasicRowMins<T> row_mins(T const* M)
+{
+	BasicRowMins<T> mins{std::numeric_limits<T>::max(), std::numeric_limits<T>::max(), 0, false};
+	[&]<uint32_t... K>(std::integer_sequence<uint32_t, K...>) {
+		(update_row_mins(mins, M[K], K), ...);
+	}(std::make_integer_sequence<uint32_t, D>{});
+	return mins;
+}
+
+
+template <typename T>
+inline BasicRowMins<T> row_mins(T const* M, uint32_t degree)
+{
+	BasicRowMins<T> mins{std::numeric_limits<T>::max(), std::numeric_limits<T>::max(), 0, false};
+	for (uint32_t k{0}; k < degree; ++k) {
+		update_row_mins(mins, M[k], k);
+	}
+	return mins;
+}
+
+
+// Row degrees of the 5G base graphs (3 to 10 and 19 in BG1 and BG2) get a fully unrolled scan, others the loop
+template <typename T>
+inline BasicRowMins<T> row_mins_by_degree(T const* M, uint32_t degree)
+{
+	switch (degree) {
+		case 3: return row_mins<3>(M);
+		case 4: return row_mins<4>(M);
+		case 5: return row_mins<5>(M);
+		case 6: return row_mins<6>(M);
+		case 7: return row_mins<7>(M);
+		case 8: return row_mins<8>(M);
+		case 9: return row_mins<9>(M);
+		case 10: return row_mins<10>(M);
+		case 19: return row_mins<19>(M);
+		default: return row_mins(M, degree);
+	}
+}
+
+
+// Min-sum check node update of rows [row_begin, row_end) at the given iteration:
+// E = sign * corrected (min over other edges of |M|)
+template <DecodingMode MODE = DecodingMode::SYNDROME, typename T = double, typename Correction>
+inline void min_sum_check_nodes(DecoderContext const& ctx, DecoderScratch & sc, size_t row_begin, size_t row_end, Correction const& correction, size_t iteration)
+{
+	std::vector<uint32_t> const& row_ptr{ctx.row_ptr()};
+	MessageBuffers<T> buffers{message_buffers<T>(sc)};
+	for (size_t j{row_begin}; j < row_end; ++j) {
+		uint32_t degree{row_ptr[j + 1] - row_ptr[j]};
+		T const* M{buffers.M.data() + row_ptr[j]};
+		T * E{buffers.E.data() + row_ptr[j]};
+		BasicRowMins<T> mins{row_mins_by_degree(M, degree)};
+		bool sign{mins.sign != target_parity<MODE>(sc, j)};
+		T min_1{static_cast<T>(correction.apply(mins.min_1, iteration, degree))};
+		T min_2{static_cast<T>(correction.apply(mins.min_2, iteration, degree))};
+		for (uint32_t k{0}; k < degree; ++k) {
+			T val{k == mins.min_1_pos ? min_2 : min_1};
+			E[k] = (sign != (M[k] < 0)) ? -val : val;
+		}
+	}
+}
+
+
+// Runtime-rule form, dispatched once per row range
+inline void min_sum_check_nodes(DecoderContext const& ctx, DecoderScratch & sc, size_t row_begin, size_t row_end, MinSumRule const& rule, size_t iteration)
+{
+	with_correction(rule, [&](auto const& correction) { min_sum_check_nodes(ctx, sc, row_begin, row_end, correction, iteration); });
+}
+
+
+// Sum-product check node update of rows [row_begin, row_end): phi of the row sum minus own term replaces the pairwise exclusion
+template <DecodingMode MODE = DecodingMode::SYNDROME, typename T = double>
+inline void sum_product_check_nodes(DecoderContext const& ctx, DecoderScratch & sc, size_t row_begin, size_t row_end)
+{
+	std::vector<uint32_t> const& row_ptr{ctx.row_ptr()};
+	MessageBuffers<T> buffers{message_buffers<T>(sc)};
+	std::vector<T> & M{buffers.M};
+	std::vector<T> & E{buffers.E};
+	for (size_t j{row_begin}; j < row_end; ++j) {
+		T phi_sum{0};
+		bool sign{target_parity<MODE>(sc, j)};
+		for (uint32_t e{row_ptr[j]}; e < row_ptr[j + 1]; ++e) {
+			E[e] = phi_clamped(std::abs(M[e]));
+			phi_sum += E[e];
+			sign ^= M[e] < 0;
+		}
+		for (uint32_t e{row_ptr[j]}; e < row_ptr[j + 1]; ++e) {
+			T val{phi_clamped(phi_sum - E[e])};
+			E[e] = (sign != (M[e] < 0)) ? -val : val;
+		}
+	}
+}
+
+
+// Same update with phi given by a PhiTable (or any callable with value_type), sums in its value_type
+template <DecodingMode MODE = DecodingMode::SYNDROME, typename Phi>
+inline void sum_product_check_nodes(DecoderContext const& ctx, DecoderScratch & sc, size_t row_begin, size_t row_end, Phi const& phi)
+{
+	using T = typename Phi::value_type;
+	std::vector<uint32_t> const& row_ptr{ctx.row_ptr()};
+	for (size_t j{row_begin}; j < row_end; ++j) {
+		T phi_sum{0};
+		bool sign{target_parity<MODE>(sc, j)};
+		for (uint32_t e{row_ptr[j]}; e < row_ptr[j + 1]; ++e) {
+			T phi_e{phi(static_cast<T>(std::abs(sc.M[e])))};
+			sc.E[e] = phi_e;
+			phi_sum += phi_e;
+			sign ^= sc.M[e] < 0;
+		}
+		for (uint32_t e{row_ptr[j]}; e < row_ptr[j + 1]; ++e) {
+			double val{phi(phi_sum - static_cast<T>(sc.E[e]))};
+			sc.E[e] = (sign != (sc.M[e] < 0)) ? -val : val;
+		}
+	}
+}
+
+
+#endif
@@ -0,0 +1,57 @@
+#include "decoder-context.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+
+DecoderContext::DecoderContext(BinarySparseMatrix H, size_t number_of_threads) : m_H{std::move(H)}
+{
+	if (number_of_threads == 0) {
+		throw std::runtime_error{"DecoderContext: number of threads must be positive"};
+	}
+
+	size_t nnz{m_H.non_zeros()};
+	m_edge_row.resize(nnz);
+	m_row_degrees.resize(rows());
+	for (size_t j{0}; j < rows(); ++j) {
+		m_row_degrees[j] = row_ptr()[j + 1] - row_ptr()[j];
+		m_max_row_degree = std::max(m_max_row_degree, m_row_degrees[j]);
+		std::fill(m_edge_row.begin() + row_ptr()[j], m_edge_row.begin() + row_ptr()[j + 1], j);
+	}
+
+	// CSC entries of a column are ordered by row, so the k-th edge of every column is met in CSR order
+	m_col_degrees.resize(cols());
+	for (size_t i{0}; i < cols(); ++i) {
+		m_col_degrees[i] = col_ptr()[i + 1] - col_ptr()[i];
+	}
+	m_col_edges.resize(nnz);
+	m_csr_to_csc.resize(nnz);
+	std::vector<uint32_t> fill{col_ptr().begin(), col_ptr().end() - 1};
+	for (uint32_t e{0}; e < nnz; ++e) {
+		uint32_t pos{fill[edge_col()[e]]++};
+		m_col_edges[pos] = e;
+		m_csr_to_csc[e] = pos;
+	}
+
+	m_scratch.resize(number_of_threads);
+	for (DecoderScratch & scratch : m_scratch) {
+		scratch.L.resize(cols());
+		scratch.R.resize(cols());
+		scratch.s.resize(rows());
+		scratch.syndrome.reset(rows(), cols(), scratch.s);
+	}
+}
+
+
+DecoderContext::DecoderContext(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, size_t number_of_threads) :
+	DecoderContext{BinarySparseMatrix{H}, number_of_threads}
+{}
+
+
+DecoderScratch & DecoderContext::scratch(size_t thread_index) const
+{
+	if (thread_index >= m_scratch.size()) {
+		throw std::runtime_error{"DecoderContext: invalid thread index"};
+	}
+	return m_scratch[thread_index];
+}
@@ -0,0 +1,108 @@
+#ifndef DECODER_CONTEXT_H
+#define DECODER_CONTEXT_H
+
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "GF2.hpp"
+#include "binary-sparse-matrix.hpp"
+#include "ldpc-utils.hpp"
+#include "residual-queue.hpp"
+#include "syndrome-tracker.hpp"
+
+
+// Check-to-variable messages of one check row in compressed form. min_1 and min_2 are already corrected
+// (normalized or offset); the message on edge e is min_2 for e == min_1_pos and min_1 otherwise,
+// negative when sign differs from the sign of the variable-to-check message on e.
+struct CompressedCheckNode
+{
+	double min_1;
+	double min_2;
+	uint32_t min_1_pos;
+	bool sign;
+};
+
+
+// Width of the messages of the context decoders. FLOAT keeps M, E and L in float (halving their memory traffic),
+// for the flooding and layered algorithms; corrections and the syndrome logic are unchanged.
+enum class MessagePrecision{DOUBLE, FLOAT};
+
+
+// Per-thread working memory of the context decoders. Node-sized buffers are allocated in DecoderContext
+// constructor, edge-sized ones by the first decoding call that needs them, so after warm-up decoding
+// does not touch the allocator.
+struct DecoderScratch
+{
+	std::vector<double> M; // Variable-to-check messages, CSR edge order
+	std::vector<double> E; // Check-to-variable messages, CSR edge order
+	std::vector<double> L; // Posterior LLRs (belief r for layered schedule)
+	std::vector<double> L_next; // Posterior LLRs being accumulated (compressed decoders)
+	std::vector<double> R; // Channel LLRs
+	std::vector<unsigned char> s; // Target syndrome
+	SyndromeTracker syndrome; // Hard decision and unsatisfied checks
+	std::vector<CompressedCheckNode> check_nodes; // Compressed check-to-variable messages, one per row (uncorrected running minima in shuffled min-sum)
+	std::vector<uint64_t> M_signs; // Signs of variable-to-check messages, one bit per edge
+	std::vector<double> phi_M; // phi(|M|) per edge (shuffled sum-product)
+	std::vector<double> phi_sums; // Row sums of phi_M (shuffled sum-product)
+	std::vector<unsigned char> row_signs; // Parity of negative M per row xor target syndrome (shuffled sum-product)
+	std::vector<double> E_applied; // Check-to-variable messages already added to L (residual BP, E holds the candidates)
+	ResidualQueue residuals; // Residual of every row (residual BP)
+	std::vector<size_t> row_stamps; // Last commit that recomputed each row (residual BP)
+	std::vector<float> M_float; // M, E, L and R of the float message path (DecoderParams::precision), sized on first use
+	std::vector<float> E_float;
+	std::vector<float> L_float;
+	std::vector<float> R_float;
+	std::optional<MessagePrecision> resumable; // Precision of the messages the last decoding of the loaded frame left in E or E_float, none if nothing to resume
+};
+
+
+// Topology of a parity-check matrix precomputed once and shared by all decoding calls on it.
+// Edges are the ones of H as a BinarySparseMatrix, numbered in CSR (row-major) order: edges of check j are [row_ptr[j], row_ptr[j + 1]),
+// edge e connects check edge_row[e] with variable edge_col[e].
+// CSC view: k-th edge of variable i in column order is col_edges[col_ptr[i] + k] (a CSR edge number),
+// its check row is col_rows[col_ptr[i] + k], and csr_to_csc is the inverse permutation.
+// Like MemoryManager, the context owns scratch buffers for number_of_threads concurrent decoders;
+// each thread passes its own thread_index to the decoding functions.
+class DecoderContext
+{
+public:
+	DecoderContext(BinarySparseMatrix H, size_t number_of_threads = 1);
+	DecoderContext(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, size_t number_of_threads = 1);
+	BinarySparseMatrix const& H() const { return m_H; }
+	size_t rows() const { return m_H.rows(); }
+	size_t cols() const { return m_H.cols(); }
+	size_t non_zeros() const { return m_H.non_zeros(); }
+	size_t threads_number() const { return m_scratch.size(); }
+	std::vector<uint32_t> const& row_ptr() const { return m_H.row_ptr(); }
+	std::vector<uint32_t> const& edge_row() const { return m_edge_row; }
+	std::vector<uint32_t> const& edge_col() const { return m_H.col_indices(); }
+	std::vector<uint32_t> const& col_ptr() const { return m_H.col_ptr(); }
+	std::vector<uint32_t> const& col_edges() const { return m_col_edges; }
+	std::vector<uint32_t> const& col_rows() const { return m_H.row_indices(); }
+	std::vector<uint32_t> const& csr_to_csc() const { return m_csr_to_csc; }
+	std::vector<uint32_t> const& row_degrees() const { return m_row_degrees; }
+	std::vector<uint32_t> const& col_degrees() const { return m_col_degrees; }
+	uint32_t max_row_degree() const { return m_max_row_degree; }
+	template <typename Func>
+	void for_each_row_of(size_t i, Func f) const // Topology callback for SyndromeTracker
+	{
+		for (uint32_t j : m_H.col(i)) {
+			f(j);
+		}
+	}
+	DecoderScratch & scratch(size_t thread_index) const;
+private:
+	BinarySparseMatrix m_H;
+	std::vector<uint32_t> m_edge_row;
+	std::vector<uint32_t> m_col_edges;
+	std::vector<uint32_t> m_csr_to_csc;
+	std::vector<uint32_t> m_row_degrees;
+	std::vector<uint32_t> m_col_degrees;
+	uint32_t m_max_row_degree{0};
+	mutable std::vector<DecoderScratch> m_scratch;
+};
+
+
+#endif
@@ -2,6 +2,7 @@
 #include <tuple>
 #include <iostream>
 #include <iomanip>
+#include <numeric>
 
 
 std::vector<GF2> hard_decision(std::vector<double> const& llrs)
@@ -15,12 +16,6 @@ std::vector<GF2> hard_decision(std::vector<double> const& llrs)
 }
 
 
-double phi(double x)
-{
-	return -log(tanh(x / 2.0));
-}
-
-
 auto make_ab(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H) -> std::tuple<std::vector<std::vector<size_t>>, std::vector<std::vector<size_t>>>
 {
 	std::vector<std::vector<size_t>> a(H.cols()), b(H.rows());
@@ -36,93 +31,31 @@ auto make_ab(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H) -> std::tuple<s
 }
 
 
-std::tuple<double, double, size_t> find_2_mins(std::vector<std::vector<size_t>> const& B, std::vector<std::vector<LLR>> const& L, size_t string_number)
-{
-	std::function<double&(double &, double &)> max =
-	[](double & a, double & b) -> double&
-	{
-		return (b > a) ? b : a;
-	};
-
-	double min_1{L[string_number][B[string_number][0]].beta()}, min_2{L[string_number][B[string_number][0]].beta()};
-	for (size_t index : B[string_number]) {
-		if (L[string_number][index].beta() < std::max(min_1, min_2)) {
-			max(min_1, min_2) = L[string_number][index].beta();
-		}
-	}
-	std::tie(min_1, min_2) = std::minmax(min_1, min_2);
-
-	// Finding position of min_1 with precision E
-	double E{1e-6};
-	size_t min_1_pos = -1;
-	for (size_t index : B[string_number]) {
-		if (abs(L[string_number][index].beta() - min_1) < E) {
-			min_1_pos = index;
-		}
-	}
-
-	if (min_1_pos == -1) {
-		throw std::runtime_error{"Min 1 position not found"};
-	}
-
-	return {min_1, min_2, min_1_pos};
-}
-
-
-GF2 compute_overall_sign(std::vector<std::vector<size_t>> const& B, std::vector<std::vector<LLR>> const& L, size_t string_number)
-{
-	GF2 overall_sign{0};
-	for (size_t index : B[string_number]) {
-		overall_sign += L[string_number][index].alpha();
-	}
-	return overall_sign;
-}
-
-
-std::tuple<double, double, size_t> find_2_mins(Eigen::SparseMatrix<LLR, Eigen::RowMajor> const& L, size_t string_number)
+// Single pass: the first of equal minima is min_1, the other one becomes min_2
+std::tuple<double, double, size_t> find_2_mins(Eigen::Map<Eigen::SparseMatrix<LLR, Eigen::RowMajor>> const& L, size_t string_number)
 {
-	// std::vector<double> v;
-
-	// for (Eigen::SparseMatrix<LLR, Eigen::RowMajor>::InnerIterator it{L, string_number}; it; ++it) {
-	// 	v.push_back(it.value().beta());
-	// }
-	// std::vector<double>::iterator iter = std::find(v.begin(), v.end(), *std::min_element(v.begin(), v.end()));
-	// size_t min_1_pos_nnz = std::distance(v.begin(), iter);
-	// size_t min_1_pos = L.innerIndexPtr()[L.outerIndexPtr()[string_number] + min_1_pos_nnz];
-	// std::sort(v.begin(), v.end());
-
-	// return {v[0], v[1], min_1_pos};
-
-
-	Eigen::SparseMatrix<LLR, Eigen::RowMajor>::InnerIterator first{L, string_number};
+	Eigen::Map<Eigen::SparseMatrix<LLR, Eigen::RowMajor>>::InnerIterator first{L, static_cast<Eigen::Index>(string_number)};
 	double min_1{std::numeric_limits<double>::max()};
 	double min_2{std::numeric_limits<double>::max()};
-	size_t min_1_pos{first.col()};
-
-	// Ищем первый минимум
-	for (Eigen::SparseMatrix<LLR, Eigen::RowMajor>::InnerIterator it{L, string_number}; it; ++it) {
-		if (it.value().beta() < min_1) {
-			min_1 = it.value().beta();
-			min_1_pos = it.col();
-		}
-	}
+	size_t min_1_pos{static_cast<size_t>(first.col())};
 
-	// Ищем второй минимум
-	for (Eigen::SparseMatrix<LLR, Eigen::RowMajor>::InnerIterator it{L, string_number}; it; ++it) {
-		if (it.value().beta()  < min_2 && it.col() != min_1_pos) {
-			min_2 = it.value().beta();
-		}
+	for (Eigen::Map<Eigen::SparseMatrix<LLR, Eigen::RowMajor>>::InnerIterator it{first}; it; ++it) {
+		double beta{it.value().beta()};
+		bool lower{beta < min_1};
+		min_2 = lower ? min_1 : std::min(min_2, beta);
+		min_1_pos = lower ? static_cast<size_t>(it.col()) : min_1_pos;
+		min_1 = lower ? beta : min_1;
 	}
 
 	return {min_1, min_2, min_1_pos};
 }
 
 
-GF2 compute_overall_sign(Eigen::SparseMatrix<LLR, Eigen::RowMajor> const& L, size_t string_number)
+GF2 compute_overall_sign(Eigen::Map<Eigen::SparseMatrix<LLR, Eigen::RowMajor>> const& L, size_t string_number)
 {
 	GF2 overall_sign{0};
 
-	for (Eigen::SparseMatrix<LLR, Eigen::RowMajor>::InnerIterator it{L, string_number}; it; ++it) {
+	for (Eigen::Map<Eigen::SparseMatrix<LLR, Eigen::RowMajor>>::InnerIterator it{L, string_number}; it; ++it) {
 		overall_sign += it.value().alpha();
 	}
 
@@ -130,214 +63,106 @@ GF2 compute_overall_sign(Eigen::SparseMatrix<LLR, Eigen::RowMajor> const& L, siz
 }
 
 
-std::tuple<double, double, size_t> find_2_mins(Eigen::Map<Eigen::SparseMatrix<LLR, Eigen::RowMajor>> const& L, size_t string_number)
+namespace
 {
-	// std::vector<double> v;
-
-	// for (Eigen::SparseMatrix<LLR, Eigen::RowMajor>::InnerIterator it{L, string_number}; it; ++it) {
-	// 	v.push_back(it.value().beta());
-	// }
-	// std::vector<double>::iterator iter = std::find(v.begin(), v.end(), *std::min_element(v.begin(), v.end()));
-	// size_t min_1_pos_nnz = std::distance(v.begin(), iter);
-	// size_t min_1_pos = L.innerIndexPtr()[L.outerIndexPtr()[string_number] + min_1_pos_nnz];
-	// std::sort(v.begin(), v.end());
-
-	// return {v[0], v[1], min_1_pos};
-
 
-	Eigen::Map<Eigen::SparseMatrix<LLR, Eigen::RowMajor>>::InnerIterator first{L, string_number};
-	double min_1{std::numeric_limits<double>::max()};
-	double min_2{std::numeric_limits<double>::max()};
-	size_t min_1_pos{first.col()};
-
-	// Ищем первый минимум
-	for (Eigen::Map<Eigen::SparseMatrix<LLR, Eigen::RowMajor>>::InnerIterator it{L, string_number}; it; ++it) {
-		if (it.value().beta() < min_1) {
-			min_1 = it.value().beta();
-			min_1_pos = it.col();
-		}
-	}
-
-	// Ищем второй минимум
-	for (Eigen::Map<Eigen::SparseMatrix<LLR, Eigen::RowMajor>>::InnerIterator it{L, string_number}; it; ++it) {
-		if (it.value().beta()  < min_2 && it.col() != min_1_pos) {
-			min_2 = it.value().beta();
-		}
-	}
+// Legacy entry points decode with a DecoderContext built for the call; verbose traces every iteration to std::cout
+Eigen::VectorX<GF2> decode_with_new_context(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, LDPC_algo alg_type, std::vector<LLR> const& R, Eigen::VectorX<GF2> const* s, double scale, size_t layer_size, size_t max_iters, bool verbose)
+{
+	DecoderContext ctx{H};
+	DecoderParams params;
+	params.scale = scale;
+	params.layer_size = layer_size;
+	params.max_iters = max_iters;
+	params.trace = verbose ? &std::cout : nullptr;
+	return s ? decode_to_syndrome(ctx, 0, alg_type, R, *s, params) : decode(ctx, 0, alg_type, R, params);
+}
 
-	return {min_1, min_2, min_1_pos};
 }
 
 
-GF2 compute_overall_sign(Eigen::Map<Eigen::SparseMatrix<LLR, Eigen::RowMajor>> const& L, size_t string_number)
+Eigen::VectorX<GF2> decode_sum_product(Eigen::SparseMatrix<GF2, Eigen::RowMajor> H, std::vector<double> const& R, size_t max_iters, bool verbose)
 {
-	GF2 overall_sign{0};
-
-	for (Eigen::Map<Eigen::SparseMatrix<LLR, Eigen::RowMajor>>::InnerIterator it{L, string_number}; it; ++it) {
-		overall_sign += it.value().alpha();
-	}
-
-	return overall_sign;
+	return decode_with_new_context(H, LDPC_algo::SP, {R.begin(), R.end()}, nullptr, 1.0, 1, max_iters, verbose);
 }
 
 
-struct size_t_hash
+Eigen::VectorX<GF2> decode_sum_product_opt(Eigen::SparseMatrix<GF2, Eigen::RowMajor> H, std::vector<LLR> const& R, size_t max_iters, bool verbose)
 {
-	std::size_t operator()(const std::pair<size_t, size_t>& k) const
-	{
-		return std::hash<size_t>()(k.first) ^
-			(std::hash<size_t>()(k.second) << 1);
-	}
-};
-typedef std::unordered_map<std::pair<size_t, size_t>, LLR, size_t_hash> lights_sparse_m_t;
+	return decode_with_new_context(H, LDPC_algo::SP, R, nullptr, 1.0, 1, max_iters, verbose);
+}
 
 
-std::tuple<double, double, size_t> find_2_mins(std::vector<std::vector<size_t>> const& B, lights_sparse_m_t const& L, size_t string_number)
+Eigen::VectorX<GF2> decode_normalized_min_sum(Eigen::SparseMatrix<GF2, Eigen::RowMajor> H, std::vector<LLR> const& R, double scale, size_t max_iters, bool verbose)
 {
-	std::function<double&(double &, double &)> max =
-	[](double & a, double & b) -> double&
-	{
-		return (b > a) ? b : a;
-	};
-
-	double min_1{L.at({string_number, B[string_number][0]}).beta()}, min_2{L.at({string_number, B[string_number][0]}).beta()};
-	for (size_t index : B[string_number]) {
-		if (L.at({string_number, index}).beta() < std::max(min_1, min_2)) {
-			max(min_1, min_2) = L.at({string_number, index}).beta();
-		}
-	}
-	std::tie(min_1, min_2) = std::minmax(min_1, min_2);
-
-	// Finding position of min_1 with precision E
-	double E{1e-10};
-	size_t min_1_pos = -1;
-	for (size_t index : B[string_number]) {
-		if (abs(L.at({string_number, index}).beta() - min_1) < E) {
-			min_1_pos = index;
-		}
-	}
-
-	if (min_1_pos == -1) {
-		throw std::runtime_error{"Min 1 position not found"};
-	}
-
-	return {min_1, min_2, min_1_pos};
+	return decode_with_new_context(H, LDPC_algo::NMS, R, nullptr, scale, 1, max_iters, verbose);
 }
 
 
-GF2 compute_overall_sign(std::vector<std::vector<size_t>> const& B, lights_sparse_m_t const& L, size_t string_number)
+Eigen::VectorX<GF2> decode_normalized_min_sum_opt(Eigen::SparseMatrix<GF2, Eigen::RowMajor> H, std::vector<LLR> const& R, double scale, size_t max_iters, bool verbose)
 {
-	GF2 overall_sign{0};
-	for (size_t index : B[string_number]) {
-		overall_sign += L.at({string_number, index}).alpha();
-	}
-	return overall_sign;
+	return decode_with_new_context(H, LDPC_algo::NMS, R, nullptr, scale, 1, max_iters, verbose);
 }
 
 
-Eigen::VectorX<GF2> decode_sum_product(Eigen::SparseMatrix<GF2, Eigen::RowMajor> H, std::vector<double> const& R, size_t max_iters, bool verbose)
+Eigen::VectorX<GF2> decode_layered_normalized_min_sum(Eigen::SparseMatrix<GF2, Eigen::RowMajor> H, std::vector<LLR> const& R, size_t layer_size, double scale, size_t max_iters, bool verbose)
 {
-	size_t m{H.rows()};
-	size_t n{H.cols()};
-
-	auto [A, B] = make_ab(H);
-
-	std::vector<std::vector<double>> M(m, std::vector<double>(n));
-	for (size_t i{0}; i < n; ++i) {
-		for (size_t j{0}; j < m; ++j) {
-			M[j][i] = R[i];
-		}
-	}
-
-	size_t I{0};
-	std::vector<std::vector<double>> E(m, std::vector<double>(n));
-	while(true) {
+	return decode_with_new_context(H, LDPC_algo::LNMS, R, nullptr, scale, layer_size, max_iters, verbose);
+}
 
-		if (verbose) { 
-			std::cout << "Iteration " << I << ":\n";
-		}
 
-		for (size_t j{0}; j < m; ++j) {
-			for (size_t i : B[j]) {
-				double product{1.0};
-				for (size_t i_ : B[j]) {
-					if (i_ != i) {
-						product *= tanh(M[j][i_] / 2.0);
-					}
-				}
-				E[j][i] = log((1 + product)/(1 - product));
+Eigen::VectorX<GF2> decode_sp_to_syndrome(Eigen::SparseMatrix<GF2, Eigen::RowMajor> H, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, size_t max_iters, bool verbose)
+{
+	return decode_with_new_context(H, LDPC_algo::SP, R, &s, 1.0, 1, max_iters, verbose);
+}
 
-				if (verbose) {
-					std::cout << "E[" << j << "][" << i << "] = " << E[j][i] << std::endl;
-				}
-			}
-		}
 
-		std::vector<double> L(n);
-		Eigen::VectorX<GF2> c(n);
-		for (size_t i{0}; i < n; ++i) {
-			double E_sum{0};
-			for (size_t j : A[i]) {
-				E_sum += E[j][i];
-			}
-			L[i] = E_sum + R[i];
-			c[i] = L[i] <= 0.0 ? 1 : 0; // Hard decision
-		}
+Eigen::VectorX<GF2> decode_nms_to_syndrome(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, double scale, size_t max_iters, bool verbose)
+{
+	return decode_with_new_context(H, LDPC_algo::NMS, R, &s, scale, 1, max_iters, verbose);
+}
 
-		if (verbose) {
-			std::cout << "Hard decision: ";
-			for (GF2 bit : c) {
-				std::cout << bit << " ";
-			}
-			std::cout << std::endl;
-		}
 
-		if ((I == max_iters) || (H * c).isZero()) {
-			return c;
-		}
+Eigen::VectorX<GF2> decode_nms_to_syndrome_opt(Eigen::SparseMatrix<GF2, Eigen::RowMajor> H, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, double scale, size_t max_iters, bool verbose)
+{
+	return decode_with_new_context(H, LDPC_algo::NMS, R, &s, scale, 1, max_iters, verbose);
+}
 
-		for (size_t i{0}; i < n; ++i) {
-			for (size_t j : A[i]) {
-				double E_sum{0};
-				for (size_t j_ : A[i]) {
-					if (j_ != j) {
-						E_sum += E[j_][i];
-					}
-				}
-				M[j][i] = E_sum + R[i];
 
-				if (verbose) {
-					std::cout << "M[" << j << "][" << i << "] = " << M[j][i] << std::endl;
-				}
-			}
-		}
-		++I;
-	}
+Eigen::VectorX<GF2> decode_lnms_to_syndrome(Eigen::SparseMatrix<GF2, Eigen::RowMajor> H, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, size_t layer_size, double scale, size_t max_iters, bool verbose)
+{
+	return decode_with_new_context(H, LDPC_algo::LNMS, R, &s, scale, layer_size, max_iters, verbose);
 }
 
 
-Eigen::VectorX<GF2> decode_sum_product_opt(Eigen::SparseMatrix<GF2, Eigen::RowMajor> H, std::vector<LLR> const& R, size_t max_iters, bool verbose)
+Eigen::VectorX<GF2> decode_nms_to_syndrome_r(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, MemoryManager const& mm, size_t thread_index, double scale, size_t max_iters, bool verbose)
 {
 	size_t m{H.rows()};
 	size_t n{H.cols()};
 
-	auto [A, B] = make_ab(H);
+	std::vector<std::vector<size_t>> A, B;
 
-	std::vector<std::vector<LLR>> M(m, std::vector<LLR>(n));
-	for (size_t i{0}; i < n; ++i) {
-		for (size_t j{0}; j < m; ++j) {
-			M[j][i] = R[i];
+	if (verbose) { // A and B are needed for debugging only
+		std::tie(A, B) = make_ab(H);
+	}
+
+	LLR * M_data = mm.get_Ms()[thread_index];
+	Eigen::Map<Eigen::SparseMatrix<LLR, Eigen::RowMajor>> M{m, n, mm.get_non_zeros(), mm.get_outer_index_ptr(), mm.get_inner_index_ptr(), M_data};
+	for (size_t j{0}; j < m; ++j) {
+		for (llr_spmmap_in_it M_iter{M, j}; M_iter; ++M_iter) {
+			M_iter.valueRef() = R[M_iter.col()];
 		}
 	}
 
-	if (verbose) {		
+	if (verbose) {	
+		std::cout << "Init M values:\n";	
 		for (size_t j{0}; j < m; ++j) {
 			for (size_t i{0}; i < n; ++i) {
 				if (std::find(A[i].begin(), A[i].end(), j) == A[i].end()) {
 					std::cout << "------- ";
 				}
 				else {
-					std::cout << std::setw(7) << std::setprecision(5) << M[j][i] << " ";
+					std::cout << std::setw(7) << std::setprecision(5) << M.coeff(j, i) << " ";
 				}
 			}
 			std::cout << std::endl;
@@ -345,7 +170,23 @@ Eigen::VectorX<GF2> decode_sum_product_opt(Eigen::SparseMatrix<GF2, Eigen::RowMa
 	}
 
 	size_t I{0};
-	std::vector<std::vector<LLR>> E(m, std::vector<LLR>(n));
+
+	LLR * E_data = mm.get_Es()[thread_index];
+	Eigen::Map<Eigen::SparseMatrix<LLR, Eigen::RowMajor>> E{m, n, mm.get_non_zeros(), mm.get_outer_index_ptr(), mm.get_inner_index_ptr(), E_data};
+
+	std::vector<LLR> L(n);
+	Eigen::VectorX<GF2> c(n);
+
+	int const * col_ptr{mm.get_col_ptr()};
+	int const * col_rows{mm.get_col_rows()};
+	auto rows_of = [col_ptr, col_rows](size_t i, auto f) {
+		for (int k{col_ptr[i]}; k < col_ptr[i + 1]; ++k) {
+			f(col_rows[k]);
+		}
+	};
+	SyndromeTracker syndrome;
+	syndrome.reset(m, n, s);
+
 	while(true) {
 
 		if (verbose) {
@@ -353,46 +194,42 @@ Eigen::VectorX<GF2> decode_sum_product_opt(Eigen::SparseMatrix<GF2, Eigen::RowMa
 		}
 
 		for (size_t j{0}; j < m; ++j) {
-			for (size_t i : B[j]) {
-				GF2 sign_product{0};
-				double val_sum{0.0};
-				for (size_t i_ : B[j]) {
-					if (i_ != i) {
-						val_sum += phi(M[j][i_].beta());
-						sign_product += M[j][i_].alpha();
-					}
-				}
-				E[j][i] = {sign_product, phi(val_sum)};
 
-				// if (verbose) {
-				// 	std::cout << "E[" << j << "][" << i << "] = " << E[j][i] << std::endl;
-				// }
+			auto [min_1, min_2, min_1_pos] = find_2_mins(M, j);
+			GF2 overall_sign{compute_overall_sign(M, j)};
+
+			for (llr_spmmap_in_it M_iter{M, j}, E_iter{E, j}; M_iter && E_iter; ++M_iter, ++E_iter) {
+				LLR val = (M_iter.col() == min_1_pos) ? LLR{M_iter.value().alpha() + overall_sign + s[j], min_2 * scale} : LLR{M_iter.value().alpha() + overall_sign + s[j], min_1 * scale};
+				E_iter.valueRef() = val;
 			}
 		}
 
 		if (verbose) {
+			std::cout << "E values:\n";
 			for (size_t j{0}; j < m; ++j) {
 				for (size_t i{0}; i < n; ++i) {
 					if (std::find(B[j].begin(), B[j].end(), i) == B[j].end()) {
 						std::cout << "------- ";
 					}
 					else {
-						std::cout << std::setw(7) << std::setprecision(5) << E[j][i] << " ";
+						std::cout << std::setw(7) << std::setprecision(5) << E.coeff(j, i) << " ";
 					}
 				}
 				std::cout << std::endl;
 			}
 		}
 
-		std::vector<LLR> L(n);
-		Eigen::VectorX<GF2> c(n);
-		for (size_t i{0}; i < n; ++i) {
-			LLR E_sum{0.0};
-			for (size_t j : A[i]) {
-				E_sum += E[j][i];
+		std::fill(L.begin(), L.end(), LLR{0.0});
+
+		for (size_t j{0}; j < m; ++j) {
+			for (llr_spmmap_in_it E_iter{E, j}; E_iter; ++E_iter) {
+				L[E_iter.col()] += E_iter.value();
 			}
-			L[i] = E_sum + R[i];
-			c[i] = L[i].alpha(); // Hard decision
+		}
+		std::transform(L.begin(), L.end(), R.begin(), L.begin(), std::plus<LLR>()); // Element-wise addition R to L
+		std::transform(L.begin(), L.end(), c.begin(), [](LLR const& llr) { return llr.alpha(); }); // Copy signs of L to c
+		for (size_t i{0}; i < n; ++i) {
+			syndrome.set(i, static_cast<bool>(c[i]), rows_of);
 		}
 
 		if (verbose) {
@@ -403,35 +240,25 @@ Eigen::VectorX<GF2> decode_sum_product_opt(Eigen::SparseMatrix<GF2, Eigen::RowMa
 			std::cout << std::endl;
 		}
 
-		if ((I == max_iters) || (H * c).isZero()) {
+		if ((I == max_iters) || syndrome.satisfied()) {
 			return c;
 		}
 
-		for (size_t i{0}; i < n; ++i) {
-			for (size_t j : A[i]) {
-				LLR E_sum{0.0};
-				for (size_t j_ : A[i]) {
-					if (j_ != j) {
-						E_sum += E[j_][i];
-					}
-				}
-				M[j][i] = E_sum + R[i];
-
-				// if (verbose) {
-				// 	std::cout << "M[" << j << "][" << i << "] = " << M[j][i] << std::endl;
-				// }
+		for (size_t j{0}; j < m; ++j) {
+			for (llr_spmmap_in_it M_iter{M, j}, E_iter{E, j}; M_iter && E_iter; ++M_iter, ++E_iter) {
+				M_iter.valueRef() = L[M_iter.col()] - E_iter.value(); // Sum of M_iter.col()-th column without value on j-th row
 			}
 		}
 
 		if (verbose) {
-			
+			std::cout << "M values:\n";
 			for (size_t j{0}; j < m; ++j) {
 				for (size_t i{0}; i < n; ++i) {
 					if (std::find(A[i].begin(), A[i].end(), j) == A[i].end()) {
 						std::cout << "------- ";
 					}
 					else {
-						std::cout << std::setw(7) << std::setprecision(5) << M[j][i] << " ";
+						std::cout << std::setw(7) << std::setprecision(5) << M.coeff(j, i) << " ";
 					}
 				}
 				std::cout << std::endl;
@@ -443,980 +270,149 @@ Eigen::VectorX<GF2> decode_sum_product_opt(Eigen::SparseMatrix<GF2, Eigen::RowMa
 }
 
 
-Eigen::VectorX<GF2> decode_normalized_min_sum(Eigen::SparseMatrix<GF2, Eigen::RowMajor> H, std::vector<LLR> const& R, double scale, size_t max_iters, bool verbose)
+// Calls f(r_begin, t_begin, length) for the two contiguous pieces of a circulant with the given shift:
+// check row r of the block is connected to variable t = (r + Z - shift) % Z
+template <typename Func>
+void for_circulant_segments(size_t Z, size_t shift, Func f)
 {
-	size_t m{H.rows()};
-	size_t n{H.cols()};
+	if (shift) {
+		f(0, Z - shift, shift);
+	}
+	f(shift, 0, Z - shift);
+}
 
-	auto [A, B] = make_ab(H);
 
-	Eigen::SparseMatrix<LLR> M{m, n};
-	for (size_t i{0}; i < n; ++n) {
-		for (size_t j : A[i]) {
-			M.insert(j, i) = R[i];
+Eigen::VectorX<GF2> decode_qc_nms_to_syndrome(QCMatrix const& H, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, double scale, size_t max_iters, bool verbose)
+{
+	size_t const Z{H.Z()};
+	size_t const n{H.cols()};
+	std::vector<QCMatrix::Block> const& blocks = H.blocks();
+	std::vector<size_t> const& row_ptr = H.row_ptr();
+
+	// Messages of block b occupy [b * Z, (b + 1) * Z) and are indexed by check row inside the block
+	std::vector<double> M(blocks.size() * Z);
+	std::vector<double> E(blocks.size() * Z);
+	std::vector<double> L(n);
+	std::vector<double> R_val(n);
+	std::vector<unsigned char> c_bits(n);
+
+	// Per check row state of the block row being processed
+	std::vector<double> min_1(Z);
+	std::vector<double> min_2(Z);
+	std::vector<size_t> min_1_pos(Z);
+	std::vector<unsigned char> sign(Z);
+
+	// Blocks of every base column: bit t of base column bg_j is checked by row (t + shift) % Z of each of them
+	std::vector<size_t> col_block_ptr(H.base_cols() + 1, 0);
+	std::vector<size_t> col_blocks(blocks.size());
+	for (QCMatrix::Block const& block : blocks) {
+		++col_block_ptr[block.col + 1];
+	}
+	std::partial_sum(col_block_ptr.begin(), col_block_ptr.end(), col_block_ptr.begin());
+	std::vector<size_t> fill{col_block_ptr.begin(), col_block_ptr.end() - 1};
+	for (size_t b{0}; b < blocks.size(); ++b) {
+		col_blocks[fill[blocks[b].col]++] = b;
+	}
+	auto rows_of = [&](size_t i, auto f) {
+		size_t bg_j{i / Z};
+		size_t t{i % Z};
+		for (size_t k{col_block_ptr[bg_j]}; k < col_block_ptr[bg_j + 1]; ++k) {
+			QCMatrix::Block const& block{blocks[col_blocks[k]]};
+			f(block.row * Z + (t + block.shift) % Z);
 		}
-	}
+	};
+	SyndromeTracker syndrome;
+	syndrome.reset(H.rows(), n, s);
 
-	if (verbose) {		
-		for (size_t j{0}; j < m; ++j) {
-			for (size_t i{0}; i < n; ++i) {
-				if (std::find(A[i].begin(), A[i].end(), j) == A[i].end()) {
-					std::cout << "------- ";
-				}
-				else {
-					std::cout << std::setw(7) << std::setprecision(5) << M.coeff(j, i) << " ";
-				}
-			}
-			std::cout << std::endl;
-		}
+	std::transform(R.begin(), R.end(), R_val.begin(), [](LLR const& llr) { return static_cast<double>(llr); });
+
+	for (size_t b{0}; b < blocks.size(); ++b) {
+		double * M_block = M.data() + b * Z;
+		double const * R_block = R_val.data() + blocks[b].col * Z;
+		for_circulant_segments(Z, blocks[b].shift, [&](size_t r_begin, size_t t_begin, size_t len) {
+			std::copy(R_block + t_begin, R_block + t_begin + len, M_block + r_begin);
+		});
 	}
 
 	size_t I{0};
-	Eigen::SparseMatrix<LLR> E{m, n};
 	while(true) {
 
 		if (verbose) {
 			std::cout << "Iteration " << I << ":\n";
 		}
 
-		for (size_t j{0}; j < m; ++j) {
-			for (size_t i : B[j]) {
-				GF2 sign_product{0};
-				double min_val{M.coeff(j, B[j][0]).beta()};
-				for (size_t i_ : B[j]) {
-					if (i_ != i) {
-						if (M.coeff(j, i_).beta() < min_val) {
-							min_val = M.coeff(j, i_).beta();
-						}
-						sign_product += M.coeff(j, i_).alpha();
-					}
-				}
-				E.insert(j, i) = {sign_product, min_val * scale};
+		// Check nodes: all Z rows of a block row at once
+		for (size_t bg_i{0}; bg_i < H.base_rows(); ++bg_i) {
+			std::fill(min_1.begin(), min_1.end(), std::numeric_limits<double>::max());
+			std::fill(min_2.begin(), min_2.end(), std::numeric_limits<double>::max());
+			std::fill(min_1_pos.begin(), min_1_pos.end(), row_ptr[bg_i]);
+			for (size_t r{0}; r < Z; ++r) {
+				sign[r] = static_cast<bool>(s[bg_i * Z + r]);
+			}
 
-				// if (verbose) {
-				// 	std::cout << "E[" << j << "][" << i << "] = " << E[j][i] << std::endl;
-				// }
+			for (size_t b{row_ptr[bg_i]}; b < row_ptr[bg_i + 1]; ++b) {
+				double const * M_block = M.data() + b * Z;
+				for (size_t r{0}; r < Z; ++r) {
+					double beta{std::abs(M_block[r])};
+					sign[r] ^= M_block[r] < 0;
+					min_2[r] = std::min(min_2[r], std::max(min_1[r], beta));
+					min_1_pos[r] = beta < min_1[r] ? b : min_1_pos[r];
+					min_1[r] = std::min(min_1[r], beta);
+				}
 			}
-		}
 
-		if (verbose) {
-			for (size_t j{0}; j < m; ++j) {
-				for (size_t i{0}; i < n; ++i) {
-					if (std::find(B[j].begin(), B[j].end(), i) == B[j].end()) {
-						std::cout << "------- ";
-					}
-					else {
-						std::cout << std::setw(7) << std::setprecision(5) << E.coeff(j, i) << " ";
-					}
+			for (size_t b{row_ptr[bg_i]}; b < row_ptr[bg_i + 1]; ++b) {
+				double const * M_block = M.data() + b * Z;
+				double * E_block = E.data() + b * Z;
+				for (size_t r{0}; r < Z; ++r) {
+					double val{(min_1_pos[r] == b ? min_2[r] : min_1[r]) * scale};
+					E_block[r] = (sign[r] ^ (M_block[r] < 0)) ? -val : val;
 				}
-				std::cout << std::endl;
 			}
 		}
 
-		std::vector<LLR> L(n);
-		Eigen::VectorX<GF2> c(n);
+		// Variable nodes: blocks are traversed row by row, so every column is summed in the same order as in decode_nms_to_syndrome_r
+		std::fill(L.begin(), L.end(), 0.0);
+		for (size_t b{0}; b < blocks.size(); ++b) {
+			double const * E_block = E.data() + b * Z;
+			double * L_block = L.data() + blocks[b].col * Z;
+			for_circulant_segments(Z, blocks[b].shift, [&](size_t r_begin, size_t t_begin, size_t len) {
+				for (size_t k{0}; k < len; ++k) {
+					L_block[t_begin + k] += E_block[r_begin + k];
+				}
+			});
+		}
 		for (size_t i{0}; i < n; ++i) {
-			LLR E_sum{0.0};
-			for (size_t j : A[i]) {
-				E_sum += E.coeff(j, i);
-			}
-			L[i] = E_sum + R[i];
-			c[i] = L[i].alpha(); // Hard decision
+			L[i] += R_val[i];
+			c_bits[i] = L[i] < 0; // Hard decision
+			syndrome.set(i, c_bits[i], rows_of);
 		}
 
 		if (verbose) {
 			std::cout << "Hard decision: ";
-			for (GF2 bit : c) {
-				std::cout << bit << " ";
+			for (unsigned char bit : c_bits) {
+				std::cout << static_cast<int>(bit) << " ";
 			}
 			std::cout << std::endl;
 		}
 
-		if ((I == max_iters) || (H * c).isZero()) {
+		if ((I == max_iters) || syndrome.satisfied()) {
+			Eigen::VectorX<GF2> c(n);
+			std::transform(c_bits.begin(), c_bits.end(), c.begin(), [](unsigned char bit) { return GF2{bit != 0}; });
 			return c;
 		}
 
-		for (size_t i{0}; i < n; ++i) {
-			for (size_t j : A[i]) {
-				LLR E_sum{0.0};
-				for (size_t j_ : A[i]) {
-					if (j_ != j) {
-						E_sum += E.coeff(j_, i);
-					}
-				}
-				M.insert(j, i) = E_sum + R[i];
-
-				// if (verbose) {
-				// 	std::cout << "M[" << j << "][" << i << "] = " << M[j][i] << std::endl;
-				// }
-			}
-		}
-
-		if (verbose) {
-			
-			for (size_t j{0}; j < m; ++j) {
-				for (size_t i{0}; i < n; ++i) {
-					if (std::find(A[i].begin(), A[i].end(), j) == A[i].end()) {
-						std::cout << "------- ";
-					}
-					else {
-						std::cout << std::setw(7) << std::setprecision(5) << M.coeff(j, i) << " ";
-					}
+		for (size_t b{0}; b < blocks.size(); ++b) {
+			double * M_block = M.data() + b * Z;
+			double const * E_block = E.data() + b * Z;
+			double const * L_block = L.data() + blocks[b].col * Z;
+			for_circulant_segments(Z, blocks[b].shift, [&](size_t r_begin, size_t t_begin, size_t len) {
+				for (size_t k{0}; k < len; ++k) {
+					M_block[r_begin + k] = L_block[t_begin + k] - E_block[r_begin + k];
 				}
-				std::cout << std::endl;
-			}
+			});
 		}
 
 		++I;
 	}
 }
-
-
-Eigen::VectorX<GF2> decode_normalized_min_sum_opt(Eigen::SparseMatrix<GF2, Eigen::RowMajor> H, std::vector<LLR> const& R, double scale, size_t max_iters, bool verbose)
-{
-	size_t m{H.rows()};
-	size_t n{H.cols()};
-
-	auto [A, B] = make_ab(H);
-
-	Eigen::SparseMatrix<LLR> M{m, n};
-	for (size_t i{0}; i < n; ++i) {
-		for (size_t j : A[i]) {
-			M.insert(j, i) = R[i];
-		}
-	}
-
-	if (verbose) {		
-		for (size_t j{0}; j < m; ++j) {
-			for (size_t i{0}; i < n; ++i) {
-				if (std::find(A[i].begin(), A[i].end(), j) == A[i].end()) {
-					std::cout << "------- ";
-				}
-				else {
-					std::cout << std::setw(7) << std::setprecision(5) << M.coeff(j, i) << " ";
-				}
-			}
-			std::cout << std::endl;
-		}
-	}
-
-	size_t I{0};
-	Eigen::SparseMatrix<LLR> E{m, n};
-	while(true) {
-
-		if (verbose) {
-			std::cout << "Iteration " << I << ":\n";
-		}
-
-		for (size_t j{0}; j < m; ++j) {
-
-			auto [min_1, min_2, min_1_pos] = find_2_mins(M, j);
-			GF2 overall_sign{compute_overall_sign(M, j)};
-
-			for (size_t i : B[j]) {
-
-				E.insert(j, i) = (i == min_1_pos) ? LLR{M.coeff(j, i).alpha() + overall_sign, min_2 * scale} : LLR{M.coeff(j, i).alpha() + overall_sign, min_1 * scale};
-
-				// if (verbose) {
-				// 	std::cout << "E[" << j << "][" << i << "] = " << E[j][i] << std::endl;
-				// }
-			}
-		}
-
-		if (verbose) {
-			for (size_t j{0}; j < m; ++j) {
-				for (size_t i{0}; i < n; ++i) {
-					if (std::find(B[j].begin(), B[j].end(), i) == B[j].end()) {
-						std::cout << "------- ";
-					}
-					else {
-						std::cout << std::setw(7) << std::setprecision(5) << E.coeff(j, i) << " ";
-					}
-				}
-				std::cout << std::endl;
-			}
-		}
-
-		std::vector<LLR> L(n);
-		Eigen::VectorX<GF2> c(n);
-		for (size_t i{0}; i < n; ++i) {
-			LLR E_sum{0.0};
-			for (size_t j : A[i]) {
-				E_sum += E.coeff(j, i);
-			}
-			L[i] = E_sum + R[i];
-			c[i] = L[i].alpha(); // Hard decision
-		}
-
-		if (verbose) {
-			std::cout << "Hard decision: ";
-			for (GF2 bit : c) {
-				std::cout << bit << " ";
-			}
-			std::cout << std::endl;
-		}
-
-		if ((I == max_iters) || (H * c).isZero()) {
-			return c;
-		}
-
-		for (size_t i{0}; i < n; ++i) {
-			for (size_t j : A[i]) {
-				LLR E_sum{0.0};
-				for (size_t j_ : A[i]) {
-					if (j_ != j) {
-						E_sum += E.coeff(j_, i);
-					}
-				}
-				M.insert(j, i) = E_sum + R[i];
-
-				// if (verbose) {
-				// 	std::cout << "M[" << j << "][" << i << "] = " << M[j][i] << std::endl;
-				// }
-			}
-		}
-
-		if (verbose) {
-			
-			for (size_t j{0}; j < m; ++j) {
-				for (size_t i{0}; i < n; ++i) {
-					if (std::find(A[i].begin(), A[i].end(), j) == A[i].end()) {
-						std::cout << "------- ";
-					}
-					else {
-						std::cout << std::setw(7) << std::setprecision(5) << M.coeff(j, i) << " ";
-					}
-				}
-				std::cout << std::endl;
-			}
-		}
-
-		++I;
-	}
-}
-
-
-Eigen::VectorX<GF2> decode_layered_normalized_min_sum(Eigen::SparseMatrix<GF2, Eigen::RowMajor> H, std::vector<LLR> const& R, size_t layer_size, double scale, size_t max_iters, bool verbose)
-{
-	size_t m{H.rows()};
-	size_t n{H.cols()};
-
-	if (m % layer_size) {
-		throw std::runtime_error{"Layer size incompatible"};
-	}
-	size_t layers_number{m / layer_size};
-
-	auto [A, B] = make_ab(H);
-
-	std::vector<std::vector<LLR>> L(m, std::vector<LLR>(n)); // Naming according to Anrew Thangaraj lecture (https://youtu.be/CNjdkQOAqhE?list=PLyqSpQzTE6M81HJ26ZaNv0V3ROBrcv-Kc)
-	for (size_t i{0}; i < n; ++i) {
-		for (size_t j{0}; j < m; ++j) {
-			L[j][i] = 0;
-		}
-	}
-
-	std::vector<LLR> r{R}; // Belief. To be changed in every layer.
-
-	if (verbose) {
-		std::cout << "Init r values:\n";
-		for (LLR val : r) {
-			std::cout << val << " ";
-		}
-		std::cout << std::endl;
-	}
-
-	size_t I{0};
-	std::vector<std::vector<LLR>> E(layers_number, std::vector<LLR>{});
-	while(true) {
-
-		if (verbose) {
-			std::cout << "Iteration " << I << ":\n";
-		}
-
-		for (size_t layer_counter{0}; layer_counter < layers_number; ++layer_counter) {
-			if (verbose) {
-				std::cout << "Layer " << layer_counter << ", strings from " << layer_counter * layer_size << " to " << (layer_counter + 1) * layer_size - 1 << ":\n";
-			}
-
-			// Subtraction
-			for (size_t j{layer_counter * layer_size}; j < ((layer_counter + 1) * layer_size); ++j) {
-				for (size_t index : B[j]) {
-					r[index] -= L[j][index];
-				}
-			}
-			if (verbose) {
-				std::cout << "r values after subtraction:\n";
-				for (LLR val : r) {
-					std::cout << val << " ";
-				}
-				std::cout << std::endl;
-			}
-
-			// Initialization
-			for (size_t j{layer_counter * layer_size}; j < ((layer_counter + 1) * layer_size); ++j) {
-				for (size_t index : B[j]) {
-					L[j][index] = r[index];
-				}
-			}
-			if (verbose) {
-				std::cout << "L values after initialization:\n";
-				for (size_t j{layer_counter * layer_size}; j < ((layer_counter + 1) * layer_size); ++j) {
-					for (size_t index{0}; index < n; ++index) {
-						if (std::find(B[j].begin(), B[j].end(), index) != B[j].end()) {
-							std::cout << L[j][index] << "\t";
-						}
-						else {
-							std::cout << "-----\t";
-						}
-					}
-					std::cout << std::endl;
-				}
-			}
-			
-			// Min
-			for (size_t j{layer_counter * layer_size}; j < ((layer_counter + 1) * layer_size); ++j) {
-				auto [min_1, min_2, min_1_pos] = find_2_mins(B, L, j);
-				GF2 overall_sign{compute_overall_sign(B, L, j)};
-
-				for (size_t index : B[j]) {
-					L[j][index] = (index == min_1_pos) ? LLR{L[j][index].alpha(), min_2} : LLR{L[j][index].alpha(), min_1};
-					L[j][index] = {L[j][index].alpha() + overall_sign, L[j][index].beta() * scale};
-				}
-			}
-			if (verbose) {
-				std::cout << "L values after min:\n";
-				for (size_t j{layer_counter * layer_size}; j < ((layer_counter + 1) * layer_size); ++j) {
-					for (size_t index{0}; index < n; ++index) {
-						if (std::find(B[j].begin(), B[j].end(), index) != B[j].end()) {
-							std::cout << L[j][index] << "\t";
-						}
-						else {
-							std::cout << "-----\t";
-						}
-					}
-					std::cout << std::endl;
-				}
-			}
-
-			// Sum
-			for (size_t j{layer_counter * layer_size}; j < ((layer_counter + 1) * layer_size); ++j) {
-				for (size_t index : B[j]) {
-					r[index] += L[j][index];
-				}
-			}
-			if (verbose) {
-				std::cout << "r values after sum:\n";
-				for (LLR val : r) {
-					std::cout << val << " ";
-				}
-				std::cout << std::endl;
-			}
-
-			// Check
-			Eigen::VectorX<GF2> c(n);
-			for (size_t i{0}; i < n; ++i) {
-				c[i] = r[i].alpha(); // Hard decision
-			}
-
-			if (verbose) {
-				std::cout << "Hard decision: ";
-				for (GF2 bit : c) {
-					std::cout << bit << " ";
-				}
-				std::cout << std::endl;
-			}
-
-			if ((I == max_iters) || (H * c).isZero()) {
-				return c;
-			}
-		}
-		++I;
-	}
-}
-
-
-Eigen::VectorX<GF2> decode_sp_to_syndrome(Eigen::SparseMatrix<GF2, Eigen::RowMajor> H, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, size_t max_iters, bool verbose)
-{
-	size_t m{H.rows()};
-	size_t n{H.cols()};
-
-	auto [A, B] = make_ab(H);
-
-	std::vector<std::vector<LLR>> M(m, std::vector<LLR>(n));
-	for (size_t i{0}; i < n; ++i) {
-		for (size_t j{0}; j < m; ++j) {
-			M[j][i] = R[i];
-		}
-	}
-
-	size_t I{0};
-	std::vector<std::vector<LLR>> E(m, std::vector<LLR>(n));
-	while(true) {
-
-		if (verbose) {
-			std::cout << "Iteration " << I << ":\n";
-		}
-
-		for (size_t j{0}; j < m; ++j) {
-			for (size_t i : B[j]) {
-				GF2 sign_product{0};
-				double val_sum{0.0};
-				for (size_t i_ : B[j]) {
-					if (i_ != i) {
-						val_sum += phi(M[j][i_].beta());
-						sign_product += M[j][i_].alpha();
-					}
-				}
-				sign_product += s[j];
-				E[j][i] = {sign_product, phi(val_sum)};
-
-				if (verbose) {
-					std::cout << "E[" << j << "][" << i << "] = " << E[j][i] << std::endl;
-				}
-			}
-		}
-
-		std::vector<LLR> L(n);
-		Eigen::VectorX<GF2> c(n);
-		for (size_t i{0}; i < n; ++i) {
-			LLR E_sum{0.0};
-			for (size_t j : A[i]) {
-				E_sum += E[j][i];
-			}
-			L[i] = E_sum + R[i];
-			c[i] = L[i].alpha(); // Hard decision
-		}
-
-		if (verbose) {
-			std::cout << "Hard decision: ";
-			for (GF2 bit : c) {
-				std::cout << bit << " ";
-			}
-			std::cout << std::endl;
-		}
-
-		if ((I == max_iters) || (H * c) == s) {
-			return c;
-		}
-
-		for (size_t i{0}; i < n; ++i) {
-			for (size_t j : A[i]) {
-				LLR E_sum{0.0};
-				for (size_t j_ : A[i]) {
-					if (j_ != j) {
-						E_sum += E[j_][i];
-					}
-				}
-				M[j][i] = E_sum + R[i];
-
-				if (verbose) {
-					std::cout << "M[" << j << "][" << i << "] = " << M[j][i] << std::endl;
-				}
-			}
-		}
-		++I;
-	}
-}
-
-
-Eigen::VectorX<GF2> decode_nms_to_syndrome(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, double scale, size_t max_iters, bool verbose)
-{
-	size_t m{H.rows()};
-	size_t n{H.cols()};
-
-	auto [A, B] = make_ab(H);
-
-	lights_sparse_m_t M{m};
-	for (size_t i{0}; i < n; ++i) {
-		for (size_t j : A[i]) {
-			M[{j, i}] = R[i];
-		}
-	}
-
-	if (verbose) {	
-		std::cout << "Init M values:\n";	
-		for (size_t j{0}; j < m; ++j) {
-			for (size_t i{0}; i < n; ++i) {
-				if (std::find(A[i].begin(), A[i].end(), j) == A[i].end()) {
-					std::cout << "------- ";
-				}
-				else {
-					std::cout << std::setw(7) << std::setprecision(5) << M[{j, i}] << " ";
-				}
-			}
-			std::cout << std::endl;
-		}
-	}
-
-	size_t I{0};
-	lights_sparse_m_t E{m};
-	while(true) {
-
-		if (verbose) {
-			std::cout << "Iteration " << I << ":\n";
-		}
-
-		for (size_t j{0}; j < m; ++j) {
-			for (size_t i : B[j]) {
-				GF2 sign_product{0};
-				double min_val{M[{j, B[j][0]}].beta()};
-				for (size_t i_ : B[j]) {
-					if (i_ != i) {
-						if (M[{j, i_}].beta() < min_val) {
-							min_val = M[{j, i_}].beta();
-						}
-						sign_product += M[{j, i_}].alpha();
-					}
-				}
-				sign_product += s[j];
-				E[{j, i}] = {sign_product, min_val * scale};
-			}
-		}
-
-		if (verbose) {
-			std::cout << "E values:\n";
-			for (size_t j{0}; j < m; ++j) {
-				for (size_t i{0}; i < n; ++i) {
-					if (std::find(B[j].begin(), B[j].end(), i) == B[j].end()) {
-						std::cout << "------- ";
-					}
-					else {
-						std::cout << std::setw(7) << std::setprecision(5) << E[{j, i}] << " ";
-					}
-				}
-				std::cout << std::endl;
-			}
-		}
-
-		std::vector<LLR> L(n);
-		Eigen::VectorX<GF2> c(n);
-		for (size_t i{0}; i < n; ++i) {
-			LLR E_sum{0.0};
-			for (size_t j : A[i]) {
-				E_sum += E[{j, i}];
-			}
-			L[i] = E_sum + R[i];
-			c[i] = L[i].alpha(); // Hard decision
-		}
-
-		if (verbose) {
-			std::cout << "Hard decision: ";
-			for (GF2 bit : c) {
-				std::cout << bit << " ";
-			}
-			std::cout << std::endl;
-		}
-
-		if ((I == max_iters) || (H * c) == s) {
-			return c;
-		}
-
-		for (size_t i{0}; i < n; ++i) {
-			for (size_t j : A[i]) {
-				LLR E_sum{0.0};
-				for (size_t j_ : A[i]) {
-					if (j_ != j) {
-						E_sum += E[{j_, i}];
-					}
-				}
-				M[{j, i}] = E_sum + R[i];
-			}
-		}
-
-		if (verbose) {
-			std::cout << "M values:\n";
-			for (size_t j{0}; j < m; ++j) {
-				for (size_t i{0}; i < n; ++i) {
-					if (std::find(A[i].begin(), A[i].end(), j) == A[i].end()) {
-						std::cout << "------- ";
-					}
-					else {
-						std::cout << std::setw(7) << std::setprecision(5) << M[{j, i}] << " ";
-					}
-				}
-				std::cout << std::endl;
-			}
-		}
-
-		++I;
-	}
-}
-
-
-Eigen::VectorX<GF2> decode_nms_to_syndrome_r(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, MemoryManager const& mm, size_t thread_index, double scale, size_t max_iters, bool verbose)
-{
-	size_t m{H.rows()};
-	size_t n{H.cols()};
-
-	std::vector<std::vector<size_t>> A, B;
-
-	if (verbose) { // A and B are needed for debugging only
-		std::tie(A, B) = make_ab(H);
-	}
-
-	LLR * M_data = mm.get_Ms()[thread_index];
-	Eigen::Map<Eigen::SparseMatrix<LLR, Eigen::RowMajor>> M{m, n, mm.get_non_zeros(), mm.get_outer_index_ptr(), mm.get_inner_index_ptr(), M_data};
-	for (size_t j{0}; j < m; ++j) {
-		for (llr_spmmap_in_it M_iter{M, j}; M_iter; ++M_iter) {
-			M_iter.valueRef() = R[M_iter.col()];
-		}
-	}
-
-	if (verbose) {	
-		std::cout << "Init M values:\n";	
-		for (size_t j{0}; j < m; ++j) {
-			for (size_t i{0}; i < n; ++i) {
-				if (std::find(A[i].begin(), A[i].end(), j) == A[i].end()) {
-					std::cout << "------- ";
-				}
-				else {
-					std::cout << std::setw(7) << std::setprecision(5) << M.coeff(j, i) << " ";
-				}
-			}
-			std::cout << std::endl;
-		}
-	}
-
-	size_t I{0};
-
-	LLR * E_data = mm.get_Es()[thread_index];
-	Eigen::Map<Eigen::SparseMatrix<LLR, Eigen::RowMajor>> E{m, n, mm.get_non_zeros(), mm.get_outer_index_ptr(), mm.get_inner_index_ptr(), E_data};
-
-	while(true) {
-
-		if (verbose) {
-			std::cout << "Iteration " << I << ":\n";
-		}
-
-		for (size_t j{0}; j < m; ++j) {
-
-			auto [min_1, min_2, min_1_pos] = find_2_mins(M, j);
-			GF2 overall_sign{compute_overall_sign(M, j)};
-
-			for (llr_spmmap_in_it M_iter{M, j}, E_iter{E, j}; M_iter && E_iter; ++M_iter, ++E_iter) {
-				LLR val = (M_iter.col() == min_1_pos) ? LLR{M_iter.value().alpha() + overall_sign + s[j], min_2 * scale} : LLR{M_iter.value().alpha() + overall_sign + s[j], min_1 * scale};
-				E_iter.valueRef() = val;
-			}
-		}
-
-		if (verbose) {
-			std::cout << "E values:\n";
-			for (size_t j{0}; j < m; ++j) {
-				for (size_t i{0}; i < n; ++i) {
-					if (std::find(B[j].begin(), B[j].end(), i) == B[j].end()) {
-						std::cout << "------- ";
-					}
-					else {
-						std::cout << std::setw(7) << std::setprecision(5) << E.coeff(j, i) << " ";
-					}
-				}
-				std::cout << std::endl;
-			}
-		}
-
-		std::vector<LLR> L(n, 0.0);
-		Eigen::VectorX<GF2> c(n);
-
-		for (size_t j{0}; j < m; ++j) {
-			for (llr_spmmap_in_it E_iter{E, j}; E_iter; ++E_iter) {
-				L[E_iter.col()] += E_iter.value();
-			}
-		}
-		std::transform(L.begin(), L.end(), R.begin(), L.begin(), std::plus<LLR>()); // Element-wise addition R to L
-		std::transform(L.begin(), L.end(), c.begin(), [](LLR const& llr) { return llr.alpha(); }); // Copy signs of L to c
-
-		if (verbose) {
-			std::cout << "Hard decision: ";
-			for (GF2 bit : c) {
-				std::cout << bit << " ";
-			}
-			std::cout << std::endl;
-		}
-
-		if ((I == max_iters) || (H * c) == s) {
-			return c;
-		}
-
-		for (size_t j{0}; j < m; ++j) {
-			for (llr_spmmap_in_it M_iter{M, j}, E_iter{E, j}; M_iter && E_iter; ++M_iter, ++E_iter) {
-				M_iter.valueRef() = L[M_iter.col()] - E_iter.value(); // Sum of M_iter.col()-th column without value on j-th row
-			}
-		}
-
-		if (verbose) {
-			std::cout << "M values:\n";
-			for (size_t j{0}; j < m; ++j) {
-				for (size_t i{0}; i < n; ++i) {
-					if (std::find(A[i].begin(), A[i].end(), j) == A[i].end()) {
-						std::cout << "------- ";
-					}
-					else {
-						std::cout << std::setw(7) << std::setprecision(5) << M.coeff(j, i) << " ";
-					}
-				}
-				std::cout << std::endl;
-			}
-		}
-
-		++I;
-	}
-}
-
-
-Eigen::VectorX<GF2> decode_nms_to_syndrome_opt(Eigen::SparseMatrix<GF2, Eigen::RowMajor> H, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, double scale, size_t max_iters, bool verbose)
-{
-	size_t m{H.rows()};
-	size_t n{H.cols()};
-
-	auto [A, B] = make_ab(H);
-
-	Eigen::SparseMatrix<LLR, Eigen::RowMajor> M{m, n};
-	for (size_t i{0}; i < n; ++i) {
-		for (size_t j : A[i]) {
-			M.coeffRef(j, i) = R[i];
-		}
-	}
-	M.makeCompressed();
-
-	if (verbose) {	
-		std::cout << "Init M values:\n";	
-		for (size_t j{0}; j < m; ++j) {
-			for (size_t i{0}; i < n; ++i) {
-				if (std::find(A[i].begin(), A[i].end(), j) == A[i].end()) {
-					std::cout << "------- ";
-				}
-				else {
-					std::cout << std::setw(7) << std::setprecision(5) << M.coeff(j, i) << " ";
-				}
-			}
-			std::cout << std::endl;
-		}
-	}
-
-	size_t I{0};
-	Eigen::SparseMatrix<LLR, Eigen::RowMajor> E{m, n};
-	while(true) {
-
-		if (verbose) {
-			std::cout << "Iteration " << I << ":\n";
-		}
-
-		for (size_t j{0}; j < m; ++j) {
-
-			auto [min_1, min_2, min_1_pos] = find_2_mins(M, j);
-			GF2 overall_sign{compute_overall_sign(M, j)};
-
-			for (size_t i : B[j]) {
-				LLR val = (i == min_1_pos) ? LLR{M.coeff(j, i).alpha() + overall_sign + s[j], min_2 * scale} : LLR{M.coeff(j, i).alpha() + overall_sign + s[j], min_1 * scale};
-				E.coeffRef(j, i) = val;
-			}
-		}
-
-		if (verbose) {
-			std::cout << "E values:\n";
-			for (size_t j{0}; j < m; ++j) {
-				for (size_t i{0}; i < n; ++i) {
-					if (std::find(B[j].begin(), B[j].end(), i) == B[j].end()) {
-						std::cout << "------- ";
-					}
-					else {
-						std::cout << std::setw(7) << std::setprecision(5) << E.coeff(j, i) << " ";
-					}
-				}
-				std::cout << std::endl;
-			}
-		}
-
-		std::vector<LLR> L(n);
-		Eigen::VectorX<GF2> c(n);
-		for (size_t i{0}; i < n; ++i) {
-			LLR E_sum{0.0};
-			for (size_t j : A[i]) {
-				E_sum += E.coeff(j, i);
-			}
-			L[i] = E_sum + R[i];
-			c[i] = L[i].alpha(); // Hard decision
-		}
-
-		if (verbose) {
-			std::cout << "Hard decision: ";
-			for (GF2 bit : c) {
-				std::cout << bit << " ";
-			}
-			std::cout << std::endl;
-		}
-
-		if ((I == max_iters) || (H * c) == s) {
-			return c;
-		}
-
-		for (size_t i{0}; i < n; ++i) {
-			for (size_t j : A[i]) {
-				LLR E_sum{0.0};
-				for (size_t j_ : A[i]) {
-					if (j_ != j) {
-						E_sum += E.coeff(j_, i);
-					}
-				}
-				M.coeffRef(j, i) = E_sum + R[i];
-			}
-		}
-
-		if (verbose) {
-			std::cout << "M values:\n";
-			for (size_t j{0}; j < m; ++j) {
-				for (size_t i{0}; i < n; ++i) {
-					if (std::find(A[i].begin(), A[i].end(), j) == A[i].end()) {
-						std::cout << "------- ";
-					}
-					else {
-						std::cout << std::setw(7) << std::setprecision(5) << M.coeff(j, i) << " ";
-					}
-				}
-				std::cout << std::endl;
-			}
-		}
-
-		++I;
-	}
-}
-
-
-Eigen::VectorX<GF2> decode_lnms_to_syndrome(Eigen::SparseMatrix<GF2, Eigen::RowMajor> H, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, size_t layer_size, double scale, size_t max_iters, bool verbose)
-{
-	size_t m{H.rows()};
-	size_t n{H.cols()};
-
-	if (m % layer_size) {
-		throw std::runtime_error{"Layer size incompatible"};
-	}
-	size_t layers_number{m / layer_size};
-
-	auto [A, B] = make_ab(H);
-
-	std::vector<std::vector<LLR>> L(m, std::vector<LLR>(n)); // Naming according to Anrew Thangaraj lecture (https://youtu.be/CNjdkQOAqhE?list=PLyqSpQzTE6M81HJ26ZaNv0V3ROBrcv-Kc)
-	for (size_t i{0}; i < n; ++i) {
-		for (size_t j{0}; j < m; ++j) {
-			L[j][i] = 0;
-		}
-	}
-
-	std::vector<LLR> r{R}; // Belief. To be changed in every layer.
-
-	if (verbose) {
-		std::cout << "Init r values:\n";
-		for (LLR val : r) {
-			std::cout << val << " ";
-		}
-		std::cout << std::endl;
-	}
-
-	size_t I{0};
-	std::vector<std::vector<LLR>> E(layers_number, std::vector<LLR>{});
-	while(true) {
-
-		if (verbose) {
-			std::cout << "Iteration " << I << ":\n";
-		}
-
-		for (size_t layer_counter{0}; layer_counter < layers_number; ++layer_counter) {
-			if (verbose) {
-				std::cout << "Layer " << layer_counter << ", strings from " << layer_counter * layer_size << " to " << (layer_counter + 1) * layer_size - 1 << ":\n";
-			}
-
-			// Subtraction
-			for (size_t j{layer_counter * layer_size}; j < ((layer_counter + 1) * layer_size); ++j) {
-				for (size_t index : B[j]) {
-					r[index] -= L[j][index];
-				}
-			}
-			if (verbose) {
-				std::cout << "r values after subtraction:\n";
-				for (LLR val : r) {
-					std::cout << val << " ";
-				}
-				std::cout << std::endl;
-			}
-
-			// Initialization
-			for (size_t j{layer_counter * layer_size}; j < ((layer_counter + 1) * layer_size); ++j) {
-				for (size_t index : B[j]) {
-					L[j][index] = r[index];
-				}
-			}
-			if (verbose) {
-				std::cout << "L values after initialization:\n";
-				for (size_t j{layer_counter * layer_size}; j < ((layer_counter + 1) * layer_size); ++j) {
-					for (size_t index{0}; index < n; ++index) {
-						if (std::find(B[j].begin(), B[j].end(), index) != B[j].end()) {
-							std::cout << L[j][index] << "\t";
-						}
-						else {
-							std::cout << "-----\t";
-						}
-					}
-					std::cout << std::endl;
-				}
-			}
-			
-			// Min
-			for (size_t j{layer_counter * layer_size}; j < ((layer_counter + 1) * layer_size); ++j) {
-				auto [min_1, min_2, min_1_pos] = find_2_mins(B, L, j);
-				GF2 overall_sign{compute_overall_sign(B, L, j)};
-
-				for (size_t index : B[j]) {
-					L[j][index] = (index == min_1_pos) ? LLR{L[j][index].alpha(), min_2} : LLR{L[j][index].alpha(), min_1};
-					L[j][index] = {L[j][index].alpha() + overall_sign + s[j], L[j][index].beta() * scale};
-				}
-			}
-			if (verbose) {
-				std::cout << "L values after min:\n";
-				for (size_t j{layer_counter * layer_size}; j < ((layer_counter + 1) * layer_size); ++j) {
-					for (size_t index{0}; index < n; ++index) {
-						if (std::find(B[j].begin(), B[j].end(), index) != B[j].end()) {
-							std::cout << L[j][index] << "\t";
-						}
-						else {
-							std::cout << "-----\t";
-						}
-					}
-					std::cout << std::endl;
-				}
-			}
-
-			// Sum
-			for (size_t j{layer_counter * layer_size}; j < ((layer_counter + 1) * layer_size); ++j) {
-				for (size_t index : B[j]) {
-					r[index] += L[j][index];
-				}
-			}
-			if (verbose) {
-				std::cout << "r values after sum:\n";
-				for (LLR val : r) {
-					std::cout << val << " ";
-				}
-				std::cout << std::endl;
-			}
-
-			// Check
-			Eigen::VectorX<GF2> c(n);
-			for (size_t i{0}; i < n; ++i) {
-				c[i] = r[i].alpha(); // Hard decision
-			}
-
-			if (verbose) {
-				std::cout << "Hard decision: ";
-				for (GF2 bit : c) {
-					std::cout << bit << " ";
-				}
-				std::cout << std::endl;
-			}
-
-			if ((I == max_iters) || (H * c) == s) {
-				return c;
-			}
-		}
-
-		++I;
-	}
-}
\ No newline at end of file
@@ -3,11 +3,76 @@
 
 #include <Eigen/Core>
 #include <Eigen/Sparse>
+#include <iosfwd>
+#include <span>
 #include "GF2.hpp"
+#include "bit-vector.hpp"
 #include "ldpc-utils.hpp"
-
-
-enum class LDPC_algo{SP, MS, NMS, LMS, LNMS};
+#include "decoder-context.h"
+#include "phi-approximation.hpp"
+
+
+// OMS and LOMS are offset min-sum, flooding and layered; SSP and SNMS are sum-product and normalized min-sum
+// with the shuffled (column-serial) schedule, RSP and RNMS with the residual (informed dynamic) schedule
+enum class LDPC_algo{SP, MS, NMS, LMS, LNMS, OMS, LOMS, SSP, SNMS, RSP, RNMS};
+enum class MinSumCorrection{NORMALIZED, OFFSET}; // Check node magnitude is min * value or max(min - value, 0)
+
+// Fixed-point message format for quantized min-sum decoding.
+// Channel LLRs are multiplied by 2^fraction_bits, rounded and saturated to [-(2^(bits - 1) - 1), 2^(bits - 1) - 1];
+// messages up to 8 bits are stored as int8_t, wider ones as int16_t. Normalization factor is scale_numerator / 2^scale_shift.
+// With the default format (8 bits, 2 fraction bits, scale 3/4) the FER on the BSC stays within 0.02 (absolute)
+// of decode_nms_to_syndrome_r with scale 0.75.
+struct FixedPointFormat
+{
+	unsigned bits{8};
+	unsigned fraction_bits{2};
+	unsigned scale_numerator{3};
+	unsigned scale_shift{2};
+};
+
+// Per-frame outcome of a batched decoding call
+struct BatchDecodingResult
+{
+	Eigen::VectorX<GF2> word;
+	size_t iterations;
+	bool syndrome_matches;
+};
+
+// Parameters of the context decoders. scale is used by NMS, LNMS, SNMS and RNMS, offset by OMS and LOMS (magnitude
+// max(min - offset, 0)), layer_size by the layered algorithms and group_size (columns updated together) by the shuffled ones.
+// Instead of a constant scale, normalization may follow a schedule: scale_by_iteration[I] at iteration I (its last entry
+// for later iterations) or, when that is empty, scale_by_degree[d] for check nodes of degree d (scale for degrees past its end).
+// The residual algorithms count rows() check row recomputes as one of the max_iters + 1 iterations, the work of a flooding one.
+// With warm_start the decoder does not start from the channel LLRs alone but also from the check-to-variable messages
+// left in the scratch by the previous call with DecoderParams and the same precision on the same frame, e.g. to retry
+// a failed frame with another algorithm without losing the work done.
+// With stall_window > 0 a frame is abandoned as failed once its lowest number of unsatisfied checks so far has not
+// improved for stall_window iterations (hard decision frozen or oscillating), instead of running to max_iters.
+// With trace set, the iteration numbers and hard decisions (after every layer for the layered algorithms) are written to it;
+// decoding without trace carries no trace code.
+struct DecoderParams
+{
+	double scale{0.75};
+	double offset{0.5};
+	size_t layer_size{1};
+	size_t group_size{1};
+	size_t max_iters{50};
+	std::vector<double> scale_by_iteration;
+	std::vector<double> scale_by_degree;
+	bool warm_start{false};
+	size_t stall_window{0};
+	MessagePrecision precision{MessagePrecision::DOUBLE};
+	std::ostream * trace{nullptr};
+};
+
+// Outcome of a decoding call writing its hard decision into a caller-provided buffer
+struct DecodingStats
+{
+	bool converged; // Hard decision satisfies the target syndrome
+	size_t iterations; // Check node passes performed
+	bool stalled{false}; // Abandoned early by stall detection (DecoderParams::stall_window)
+	size_t unsatisfied{0}; // Unsatisfied checks of the returned hard decision
+};
 
 using llr_spmmap_in_it = Eigen::Map<Eigen::SparseMatrix<LLR, Eigen::RowMajor>>::InnerIterator;
 
@@ -16,6 +81,10 @@ std::vector<GF2> hard_decision(std::vector<double> const& llrs);
 
 auto make_ab(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H) -> std::tuple<std::vector<std::vector<size_t>>, std::vector<std::vector<size_t>>>;
 
+// Legacy decoders taking H directly. From here to decode_nms_to_syndrome, and decode_nms_to_syndrome_opt and
+// decode_lnms_to_syndrome, build a DecoderContext for H (CSR, CSC and scratch) on every call, so they are meant for
+// one-off decoding; many frames with one matrix should reuse a DecoderContext. Their verbose traces to std::cout
+// as DecoderParams::trace does.
 Eigen::VectorX<GF2> decode_sum_product(Eigen::SparseMatrix<GF2, Eigen::RowMajor> H, std::vector<double> const& R, size_t max_iters = 50, bool verbose = false);
 
 Eigen::VectorX<GF2> decode_sum_product_opt(Eigen::SparseMatrix<GF2, Eigen::RowMajor> H, std::vector<LLR> const& R, size_t max_iters = 50, bool verbose = false);
@@ -32,6 +101,59 @@ Eigen::VectorX<GF2> decode_nms_to_syndrome(Eigen::SparseMatrix<GF2, Eigen::RowMa
 
 Eigen::VectorX<GF2> decode_nms_to_syndrome_r(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, MemoryManager const& mm, size_t thread_index, double scale = 1.0, size_t max_iters = 50, bool verbose = false);
 
+Eigen::VectorX<GF2> decode_quantized_nms_to_syndrome(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, FixedPointFormat const& format = {}, size_t max_iters = 50, bool verbose = false);
+
+// Fixed-point sum-product: messages on the grid of format (scale fields unused), phi from a FixedPointPhiTable
+Eigen::VectorX<GF2> decode_quantized_sp_to_syndrome(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, FixedPointFormat const& format = {}, size_t max_iters = 50, bool verbose = false);
+
+std::vector<BatchDecodingResult> decode_nms_to_syndrome_batch(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, std::vector<std::vector<LLR>> const& Rs, std::vector<Eigen::VectorX<GF2>> const& ss, double scale = 1.0, size_t max_iters = 50);
+
+Eigen::VectorX<GF2> decode_qc_nms_to_syndrome(QCMatrix const& H, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, double scale = 1.0, size_t max_iters = 50, bool verbose = false);
+
+// Decoding against a precomputed DecoderContext; thread_index selects the scratch buffers of the context.
+// The last layer of the layered algorithms may have fewer rows. Overloads taking scale, layer_size and max_iters
+// are shorthands for DecoderParams with these fields (and offset 0.5).
+DecodingStats decode_to_syndrome_into(DecoderContext const& ctx, size_t thread_index, LDPC_algo alg_type, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, std::span<GF2> out, DecoderParams const& params);
+
+DecodingStats decode_to_syndrome_into(DecoderContext const& ctx, size_t thread_index, LDPC_algo alg_type, std::vector<LLR> const& R, BitVector const& s, BitVector & out, DecoderParams const& params);
+
+DecodingStats decode_into(DecoderContext const& ctx, size_t thread_index, LDPC_algo alg_type, std::vector<LLR> const& R, std::span<GF2> out, DecoderParams const& params);
+
+Eigen::VectorX<GF2> decode_to_syndrome(DecoderContext const& ctx, size_t thread_index, LDPC_algo alg_type, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, DecoderParams const& params);
+
+Eigen::VectorX<GF2> decode(DecoderContext const& ctx, size_t thread_index, LDPC_algo alg_type, std::vector<LLR> const& R, DecoderParams const& params);
+
+Eigen::VectorX<GF2> decode_to_syndrome(DecoderContext const& ctx, size_t thread_index, LDPC_algo alg_type, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, double scale = 1.0, size_t layer_size = 1, size_t max_iters = 50);
+
+// Same as decode_to_syndrome with zero syndrome, i.e. decoding to a codeword
+Eigen::VectorX<GF2> decode(DecoderContext const& ctx, size_t thread_index, LDPC_algo alg_type, std::vector<LLR> const& R, double scale = 1.0, size_t layer_size = 1, size_t max_iters = 50);
+
+// Variants of decode_to_syndrome and decode writing the hard decision into out (of ctx.cols() elements).
+// They do not allocate: all working memory comes from the context scratch buffers.
+DecodingStats decode_to_syndrome_into(DecoderContext const& ctx, size_t thread_index, LDPC_algo alg_type, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, std::span<GF2> out, double scale = 1.0, size_t layer_size = 1, size_t max_iters = 50);
+
+// Packed variant: syndrome and hard decision as BitVector (out must have ctx.cols() bits)
+DecodingStats decode_to_syndrome_into(DecoderContext const& ctx, size_t thread_index, LDPC_algo alg_type, std::vector<LLR> const& R, BitVector const& s, BitVector & out, double scale = 1.0, size_t layer_size = 1, size_t max_iters = 50);
+
+DecodingStats decode_into(DecoderContext const& ctx, size_t thread_index, LDPC_algo alg_type, std::vector<LLR> const& R, std::span<GF2> out, double scale = 1.0, size_t layer_size = 1, size_t max_iters = 50);
+
+// Flooding NMS/OMS decoding keeping check-to-variable messages compressed: a CompressedCheckNode per row and
+// one sign bit per edge instead of a double per edge. correction_value is the scale for NORMALIZED correction
+// and the offset for OFFSET correction; with NORMALIZED the result equals decode_to_syndrome with LDPC_algo::NMS.
+DecodingStats decode_compressed_ms_to_syndrome_into(DecoderContext const& ctx, size_t thread_index, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, std::span<GF2> out, MinSumCorrection correction, double correction_value, size_t max_iters = 50);
+
+Eigen::VectorX<GF2> decode_compressed_ms_to_syndrome(DecoderContext const& ctx, size_t thread_index, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, MinSumCorrection correction, double correction_value, size_t max_iters = 50);
+
+// Flooding sum-product decoding with phi evaluated by a PhiTable (accuracy mode chosen at its construction);
+// check node sums are carried in the table's type. The table is read-only and may be shared between threads.
+DecodingStats decode_sp_to_syndrome_into(DecoderContext const& ctx, size_t thread_index, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, std::span<GF2> out, PhiTable<float> const& phi, size_t max_iters = 50);
+
+DecodingStats decode_sp_to_syndrome_into(DecoderContext const& ctx, size_t thread_index, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, std::span<GF2> out, PhiTable<double> const& phi, size_t max_iters = 50);
+
+Eigen::VectorX<GF2> decode_sp_to_syndrome(DecoderContext const& ctx, size_t thread_index, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, PhiTable<float> const& phi, size_t max_iters = 50);
+
+Eigen::VectorX<GF2> decode_sp_to_syndrome(DecoderContext const& ctx, size_t thread_index, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, PhiTable<double> const& phi, size_t max_iters = 50);
+
 Eigen::VectorX<GF2> decode_nms_to_syndrome_opt(Eigen::SparseMatrix<GF2, Eigen::RowMajor> H, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, double scale = 1.0, size_t max_iters = 50, bool verbose = false);
 
 Eigen::VectorX<GF2> decode_lnms_to_syndrome(Eigen::SparseMatrix<GF2, Eigen::RowMajor> H, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, size_t layer_size, double scale = 1.0, size_t max_iters = 50, bool verbose = false);
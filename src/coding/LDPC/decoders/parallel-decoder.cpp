@@ -0,0 +1,304 @@
+#include "parallel-decoder.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+
+namespace
+{
+
+size_t checked_threads_number(size_t threads_number)
+{
+	if (threads_number == 0) {
+		throw std::runtime_error{"ParallelDecoder: number of threads must be positive"};
+	}
+	return threads_number;
+}
+
+
+// Splits [0, ptr.size() - 1) into parts contiguous ranges with about the same number of edges each
+std::vector<size_t> partition_by_edges(std::vector<uint32_t> const& ptr, size_t parts)
+{
+	size_t nodes{ptr.size() - 1};
+	std::vector<size_t> bounds(parts + 1);
+	for (size_t t{0}; t < parts; ++t) {
+		uint64_t target{static_cast<uint64_t>(ptr.back()) * t / parts};
+		bounds[t] = std::lower_bound(ptr.begin(), ptr.end() - 1, target) - ptr.begin();
+	}
+	bounds[parts] = nodes;
+	return bounds;
+}
+
+}
+
+
+void ParallelDecoder::PhaseCompletion::operator()() noexcept
+{
+	decoder->m_satisfied = decoder->m_unsatisfied.load(std::memory_order_relaxed) == 0;
+}
+
+
+ParallelDecoder::ParallelDecoder(DecoderContext const& ctx, size_t threads_number) :
+	m_ctx{ctx}, m_threads_number{checked_threads_number(threads_number)},
+	m_row_bounds{partition_by_edges(ctx.row_ptr(), m_threads_number)},
+	m_col_bounds{partition_by_edges(ctx.col_ptr(), m_threads_number)},
+	m_bits(ctx.cols()), m_parity{std::make_unique<std::atomic<unsigned char>[]>(ctx.rows())},
+	m_start{static_cast<std::ptrdiff_t>(m_threads_number)},
+	m_phase{static_cast<std::ptrdiff_t>(m_threads_number), PhaseCompletion{this}}
+{
+	m_workers.reserve(m_threads_number - 1);
+	for (size_t thread_index{1}; thread_index < m_threads_number; ++thread_index) {
+		m_workers.emplace_back(&ParallelDecoder::worker, this, thread_index);
+	}
+}
+
+
+ParallelDecoder::~ParallelDecoder()
+{
+	m_shutdown = true;
+	m_start.arrive_and_wait();
+	for (std::thread & worker : m_workers) {
+		worker.join();
+	}
+}
+
+
+void ParallelDecoder::worker(size_t thread_index)
+{
+	for (;;) {
+		m_start.arrive_and_wait();
+		if (m_shutdown) {
+			return;
+		}
+		run(thread_index);
+	}
+}
+
+
+// Only the thread owning variable i writes m_bits[i]; row parities are shared, hence atomic
+void ParallelDecoder::set_hard_decision(size_t i, bool bit)
+{
+	if (static_cast<bool>(m_bits[i]) == bit) {
+		return;
+	}
+	m_bits[i] = bit;
+	m_ctx.for_each_row_of(i, [this](size_t j) {
+		if (m_parity[j].fetch_xor(1, std::memory_order_relaxed)) {
+			m_unsatisfied.fetch_sub(1, std::memory_order_relaxed);
+		}
+		else {
+			m_unsatisfied.fetch_add(1, std::memory_order_relaxed);
+		}
+	});
+}
+
+
+void ParallelDecoder::check_layers(size_t layer_size)
+{
+	if (layer_size == 0) {
+		throw std::runtime_error{"Layer size incompatible"};
+	}
+	if (layer_size == m_checked_layer_size) {
+		return;
+	}
+	std::vector<uint32_t> const& row_ptr{m_ctx.row_ptr()};
+	std::vector<uint32_t> const& edge_col{m_ctx.edge_col()};
+	m_col_stamp.assign(m_ctx.cols(), std::numeric_limits<uint32_t>::max());
+	for (size_t row_begin{0}, layer{0}; row_begin < m_ctx.rows(); row_begin += layer_size, ++layer) {
+		size_t row_end{std::min(row_begin + layer_size, m_ctx.rows())};
+		for (uint32_t e{row_ptr[row_begin]}; e < row_ptr[row_end]; ++e) {
+			if (m_col_stamp[edge_col[e]] == layer) {
+				throw std::runtime_error{"ParallelDecoder: rows of a layer must not share variables"};
+			}
+			m_col_stamp[edge_col[e]] = layer;
+		}
+	}
+	m_checked_layer_size = layer_size;
+}
+
+
+size_t ParallelDecoder::run(size_t thread_index)
+{
+	Job const job{m_job};
+	return job.layered ? run_layered(thread_index, job) : run_flooding(thread_index, job);
+}
+
+
+size_t ParallelDecoder::run_flooding(size_t thread_index, Job const& job)
+{
+	DecoderScratch & sc{*job.sc};
+	std::vector<uint32_t> const& col_ptr{m_ctx.col_ptr()};
+	std::vector<uint32_t> const& col_edges{m_ctx.col_edges()};
+	size_t row_begin{m_row_bounds[thread_index]};
+	size_t row_end{m_row_bounds[thread_index + 1]};
+	size_t col_begin{m_col_bounds[thread_index]};
+	size_t col_end{m_col_bounds[thread_index + 1]};
+
+	for (size_t i{col_begin}; i < col_end; ++i) {
+		for (uint32_t p{col_ptr[i]}; p < col_ptr[i + 1]; ++p) {
+			sc.M[col_edges[p]] = sc.R[i];
+		}
+	}
+	m_phase.arrive_and_wait();
+
+	for (size_t I{0}; ; ++I) {
+		if (job.sum_product) {
+			sum_product_check_nodes(m_ctx, sc, row_begin, row_end);
+		}
+		else {
+			min_sum_check_nodes(m_ctx, sc, row_begin, row_end, job.rule, I);
+		}
+		m_phase.arrive_and_wait();
+
+		// Column sums in CSC order add E in the same order as the serial CSR pass, so L is bit-identical
+		for (size_t i{col_begin}; i < col_end; ++i) {
+			double L{0.0};
+			for (uint32_t p{col_ptr[i]}; p < col_ptr[i + 1]; ++p) {
+				L += sc.E[col_edges[p]];
+			}
+			L += sc.R[i];
+			sc.L[i] = L;
+			set_hard_decision(i, L < 0);
+			for (uint32_t p{col_ptr[i]}; p < col_ptr[i + 1]; ++p) {
+				sc.M[col_edges[p]] = L - sc.E[col_edges[p]];
+			}
+		}
+		m_phase.arrive_and_wait();
+
+		if (I == job.max_iters || m_satisfied) {
+			return I + 1;
+		}
+	}
+}
+
+
+size_t ParallelDecoder::run_layered(size_t thread_index, Job const& job)
+{
+	DecoderScratch & sc{*job.sc};
+	std::vector<uint32_t> const& row_ptr{m_ctx.row_ptr()};
+	std::vector<uint32_t> const& edge_col{m_ctx.edge_col()};
+	size_t layers_number{(m_ctx.rows() + job.layer_size - 1) / job.layer_size};
+
+	for (size_t i{m_col_bounds[thread_index]}; i < m_col_bounds[thread_index + 1]; ++i) {
+		sc.L[i] = sc.R[i];
+		set_hard_decision(i, sc.L[i] < 0);
+	}
+	m_phase.arrive_and_wait();
+
+	for (size_t I{0}; ; ++I) {
+		for (size_t layer{0}; layer < layers_number; ++layer) {
+			size_t layer_begin{layer * job.layer_size};
+			size_t layer_rows{std::min(job.layer_size, m_ctx.rows() - layer_begin)};
+			size_t row_begin{layer_begin + layer_rows * thread_index / m_threads_number};
+			size_t row_end{layer_begin + layer_rows * (thread_index + 1) / m_threads_number};
+			uint32_t e_begin{row_ptr[row_begin]};
+			uint32_t e_end{row_ptr[row_end]};
+
+			// Layers are column-disjoint, so every belief touched here belongs to this thread alone
+			for (uint32_t e{e_begin}; e < e_end; ++e) {
+				sc.M[e] = sc.L[edge_col[e]] - sc.E[e];
+				sc.L[edge_col[e]] -= sc.E[e];
+			}
+			min_sum_check_nodes(m_ctx, sc, row_begin, row_end, job.rule, I);
+			for (uint32_t e{e_begin}; e < e_end; ++e) {
+				sc.L[edge_col[e]] += sc.E[e];
+				set_hard_decision(edge_col[e], sc.L[edge_col[e]] < 0);
+			}
+			m_phase.arrive_and_wait();
+
+			if (I == job.max_iters || m_satisfied) {
+				return I + 1;
+			}
+		}
+	}
+}
+
+
+DecodingStats ParallelDecoder::decode_to_syndrome_into(size_t scratch_index, LDPC_algo alg_type, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, std::span<GF2> out, double scale, size_t layer_size, size_t max_iters)
+{
+	DecoderParams params;
+	params.scale = scale;
+	params.layer_size = layer_size;
+	params.max_iters = max_iters;
+	return decode_to_syndrome_into(scratch_index, alg_type, R, s, out, params);
+}
+
+
+DecodingStats ParallelDecoder::decode_to_syndrome_into(size_t scratch_index, LDPC_algo alg_type, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, std::span<GF2> out, DecoderParams const& params)
+{
+	if (R.size() != m_ctx.cols() || static_cast<size_t>(s.size()) != m_ctx.rows()) {
+		throw std::runtime_error{"Frame size incompatible with decoder context"};
+	}
+	if (out.size() != m_ctx.cols()) {
+		throw std::runtime_error{"Output buffer size incompatible with decoder context"};
+	}
+
+	if (params.warm_start || params.stall_window != 0 || params.precision != MessagePrecision::DOUBLE) {
+		throw std::runtime_error{"ParallelDecoder: warm start, stall detection and float messages are not supported"};
+	}
+
+	Job job;
+	job.sc = &m_ctx.scratch(scratch_index);
+	switch (alg_type) {
+		case LDPC_algo::SP:
+			job.sum_product = true;
+			break;
+		case LDPC_algo::LMS:
+		case LDPC_algo::LNMS:
+		case LDPC_algo::LOMS:
+			job.layered = true;
+			job.rule = make_min_sum_rule(alg_type, params);
+			break;
+		case LDPC_algo::SSP:
+		case LDPC_algo::SNMS:
+		case LDPC_algo::RSP:
+		case LDPC_algo::RNMS:
+			throw std::runtime_error{"ParallelDecoder: shuffled and residual schedules are not supported"};
+		default:
+			job.rule = make_min_sum_rule(alg_type, params);
+	}
+	if (job.layered) {
+		check_layers(params.layer_size);
+	}
+	job.layer_size = params.layer_size;
+	job.max_iters = params.max_iters;
+
+	DecoderScratch & sc{*job.sc};
+	sc.resumable.reset(); // Not resumable by the sequential decoders
+	sc.M.resize(m_ctx.non_zeros());
+	if (job.layered) {
+		sc.E.assign(m_ctx.non_zeros(), 0.0);
+	}
+	else {
+		sc.E.resize(m_ctx.non_zeros());
+	}
+	for (size_t i{0}; i < m_ctx.cols(); ++i) {
+		sc.R[i] = R[i];
+	}
+	std::fill(m_bits.begin(), m_bits.end(), 0);
+	size_t unsatisfied{0};
+	for (size_t j{0}; j < m_ctx.rows(); ++j) {
+		sc.s[j] = static_cast<bool>(s[j]);
+		m_parity[j].store(sc.s[j], std::memory_order_relaxed);
+		unsatisfied += sc.s[j];
+	}
+	m_unsatisfied.store(unsatisfied, std::memory_order_relaxed);
+	m_job = job;
+
+	m_start.arrive_and_wait();
+	size_t iterations{run(0)};
+
+	for (size_t i{0}; i < m_bits.size(); ++i) {
+		out[i] = static_cast<bool>(m_bits[i]);
+	}
+	return {m_satisfied, iterations, false, m_unsatisfied.load(std::memory_order_relaxed)};
+}
+
+
+Eigen::VectorX<GF2> ParallelDecoder::decode_to_syndrome(size_t scratch_index, LDPC_algo alg_type, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, double scale, size_t layer_size, size_t max_iters)
+{
+	Eigen::VectorX<GF2> c(m_ctx.cols());
+	decode_to_syndrome_into(scratch_index, alg_type, R, s, {c.data(), m_ctx.cols()}, scale, layer_size, max_iters);
+	return c;
+}
@@ -0,0 +1,81 @@
+#ifndef PARALLEL_DECODER_H
+#define PARALLEL_DECODER_H
+
+#include <Eigen/Core>
+#include <atomic>
+#include <barrier>
+#include <memory>
+#include <span>
+#include <thread>
+#include <vector>
+#include "GF2.hpp"
+#include "ldpc-utils.hpp"
+#include "decoder-context.h"
+#include "decoders.h"
+#include "context-kernels.hpp"
+
+
+// Decodes one frame with a persistent pool of threads_number threads (the calling one included).
+// Flooding algorithms (SP, MS, NMS, OMS) split check rows and variable columns into contiguous ranges of equal edge count,
+// phases are separated by barriers. Layered algorithms (LMS, LNMS, LOMS) split the rows of every layer across threads
+// and update beliefs without locks, so every layer must be column-disjoint (no two of its rows share a variable),
+// e.g. block rows of a lifted code with layer_size = Z.
+// Message buffers are the scratch of the DecoderContext selected by scratch_index; results are bit-identical
+// to the serial context decoders. One ParallelDecoder decodes one frame at a time.
+class ParallelDecoder
+{
+public:
+	ParallelDecoder(DecoderContext const& ctx, size_t threads_number);
+	ParallelDecoder(ParallelDecoder const&) = delete;
+	ParallelDecoder & operator=(ParallelDecoder const&) = delete;
+	~ParallelDecoder();
+
+	DecodingStats decode_to_syndrome_into(size_t scratch_index, LDPC_algo alg_type, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, std::span<GF2> out, DecoderParams const& params);
+	DecodingStats decode_to_syndrome_into(size_t scratch_index, LDPC_algo alg_type, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, std::span<GF2> out, double scale = 1.0, size_t layer_size = 1, size_t max_iters = 50);
+	Eigen::VectorX<GF2> decode_to_syndrome(size_t scratch_index, LDPC_algo alg_type, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, double scale = 1.0, size_t layer_size = 1, size_t max_iters = 50);
+	size_t threads_number() const { return m_threads_number; }
+
+private:
+	struct PhaseCompletion
+	{
+		ParallelDecoder * decoder;
+		void operator()() noexcept;
+	};
+
+	// Copied by every thread when a frame starts, so a finished thread never reads the next frame's job
+	struct Job
+	{
+		DecoderScratch * sc{nullptr};
+		bool layered{false};
+		bool sum_product{false};
+		MinSumRule rule;
+		size_t layer_size{1};
+		size_t max_iters{0};
+	};
+
+	void worker(size_t thread_index);
+	size_t run(size_t thread_index);
+	size_t run_flooding(size_t thread_index, Job const& job);
+	size_t run_layered(size_t thread_index, Job const& job);
+	void set_hard_decision(size_t i, bool bit);
+	void check_layers(size_t layer_size);
+
+	DecoderContext const& m_ctx;
+	size_t m_threads_number;
+	std::vector<size_t> m_row_bounds; // Rows of thread t are [m_row_bounds[t], m_row_bounds[t + 1])
+	std::vector<size_t> m_col_bounds; // Columns of thread t are [m_col_bounds[t], m_col_bounds[t + 1])
+	std::vector<unsigned char> m_bits; // Hard decision
+	std::unique_ptr<std::atomic<unsigned char>[]> m_parity; // Parity of every row xor target syndrome
+	std::atomic<size_t> m_unsatisfied{0};
+	bool m_satisfied{false}; // Written by PhaseCompletion, read by all threads after the barrier
+	std::vector<uint32_t> m_col_stamp;
+	size_t m_checked_layer_size{0}; // Last layer size found column-disjoint
+	Job m_job;
+	bool m_shutdown{false};
+	std::barrier<> m_start;
+	std::barrier<PhaseCompletion> m_phase;
+	std::vector<std::thread> m_workers;
+};
+
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef PHI_APPROXIMATION_H
+#define PHI_APPROXIMATION_H
+
+// Approximations of phi(x) = -log(tanh(x / 2)) for the sum-product check node update
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+
+// Accuracy mode of PhiTable. Absolute errors for x >= 1/4 (smaller arguments give magnitudes above 6):
+// EXACT  - libm call clamped to [1e-12, 30], the reference;
+// LINEAR - piecewise-linear interpolation, error below 1e-3;
+// TABLE  - piecewise-constant lookup at cell midpoints, error below 0.04, no arithmetic besides indexing.
+// Table modes saturate at phi(2^-13) ~ 9.7 near zero and return 0 from x = 16 on (phi(16) ~ 2e-7).
+enum class PhiAccuracy{EXACT, LINEAR, TABLE};
+
+
+// phi over float or double. Cells are 2^-12 wide on [0, 1/4), where phi is steep, and 2^-6 wide on [1/4, 16),
+// so both tables together take about 2000 entries and stay in L1 cache.
+template <typename T>
+class PhiTable
+{
+public:
+	using value_type = T;
+
+	explicit PhiTable(PhiAccuracy accuracy = PhiAccuracy::LINEAR) : m_accuracy{accuracy}
+	{
+		// TABLE stores cell midpoints, LINEAR cell boundaries plus a closing node
+		bool const midpoints{accuracy == PhiAccuracy::TABLE};
+		m_fine.resize(FINE_CELLS + 1);
+		for (size_t k{0}; k <= FINE_CELLS; ++k) {
+			double x{(k + (midpoints ? 0.5 : 0.0)) / FINE_SCALE};
+			m_fine[k] = static_cast<T>(exact(std::max(x, 0.5 / FINE_SCALE)));
+		}
+		m_coarse.resize(COARSE_CELLS + 1);
+		for (size_t k{0}; k <= COARSE_CELLS; ++k) {
+			m_coarse[k] = static_cast<T>(exact(FINE_END + (k + (midpoints ? 0.5 : 0.0)) / COARSE_SCALE));
+		}
+	}
+
+	T operator()(T x) const
+	{
+		switch (m_accuracy) {
+			case PhiAccuracy::LINEAR:
+				return interpolate(std::max(x, T{0}));
+			case PhiAccuracy::TABLE:
+				return lookup(std::max(x, T{0}));
+			default:
+				return static_cast<T>(exact(x));
+		}
+	}
+
+	PhiAccuracy accuracy() const { return m_accuracy; }
+
+	static double exact(double x)
+	{
+		x = std::clamp(x, 1e-12, 30.0);
+		return -std::log(std::tanh(x / 2.0));
+	}
+
+private:
+	static constexpr T FINE_SCALE{4096}; // Cells per unit on [0, FINE_END)
+	static constexpr T FINE_END{0.25};
+	static constexpr T COARSE_SCALE{64}; // Cells per unit on [FINE_END, MAX_ARG)
+	static constexpr T MAX_ARG{16};
+	static constexpr size_t FINE_CELLS{1024};
+	static constexpr size_t COARSE_CELLS{1008};
+
+	T lookup(T x) const
+	{
+		if (x < FINE_END) {
+			return m_fine[static_cast<size_t>(x * FINE_SCALE)];
+		}
+		if (x < MAX_ARG) {
+			return m_coarse[static_cast<size_t>((x - FINE_END) * COARSE_SCALE)];
+		}
+		return T{0};
+	}
+
+	T interpolate(T x) const
+	{
+		if (x < FINE_END) {
+			T pos{x * FINE_SCALE};
+			size_t k{static_cast<size_t>(pos)};
+			return m_fine[k] + (pos - static_cast<T>(k)) * (m_fine[k + 1] - m_fine[k]);
+		}
+		if (x < MAX_ARG) {
+			T pos{(x - FINE_END) * COARSE_SCALE};
+			size_t k{static_cast<size_t>(pos)};
+			return m_coarse[k] + (pos - static_cast<T>(k)) * (m_coarse[k + 1] - m_coarse[k]);
+		}
+		return T{0};
+	}
+
+	PhiAccuracy m_accuracy;
+	std::vector<T> m_fine;
+	std::vector<T> m_coarse;
+};
+
+
+// phi for fixed-point messages with fraction_bits fractional bits and magnitudes up to 2^(bits - 1) - 1.
+// phi values live on a finer grid (up to 6 more fractional bits, 12 at most): on the message grid the phi of
+// every reliable message would round to zero and their sum would make the check node output saturate.
+// forward maps a message magnitude to the phi grid, backward maps a (summed) phi value back to a magnitude;
+// both round to the nearest grid point and saturate at zero arguments.
+class FixedPointPhiTable
+{
+public:
+	FixedPointPhiTable(unsigned bits, unsigned fraction_bits)
+	{
+		if (bits < 2 || bits > 16 || fraction_bits >= bits) {
+			throw std::runtime_error{"Invalid fixed-point format"};
+		}
+		m_max_value = (int32_t{1} << (bits - 1)) - 1;
+		m_phi_fraction_bits = std::max(fraction_bits, std::min(fraction_bits + 6, 12u));
+		double const step{1.0 / (1 << fraction_bits)};
+		double const phi_step{1.0 / (1 << m_phi_fraction_bits)};
+
+		m_forward.resize(m_max_value + 1);
+		for (int32_t q{0}; q <= m_max_value; ++q) {
+			m_forward[q] = static_cast<int32_t>(std::lround(PhiTable<double>::exact(q ? q * step : step / 2) / phi_step));
+		}
+		// Ends with the first phi value mapped to zero magnitude, larger arguments are clamped to it
+		m_backward.push_back(m_max_value);
+		while (m_backward.back() > 0) {
+			double phi{PhiTable<double>::exact(m_backward.size() * phi_step)};
+			m_backward.push_back(static_cast<int32_t>(std::min<double>(std::lround(phi / step), m_max_value)));
+		}
+	}
+
+	int32_t forward(int32_t q) const { return m_forward[q]; }
+	int32_t backward(int32_t p) const { return m_backward[std::min<size_t>(p, m_backward.size() - 1)]; }
+	int32_t max_value() const { return m_max_value; }
+	unsigned phi_fraction_bits() const { return m_phi_fraction_bits; }
+
+private:
+	int32_t m_max_value;
+	unsigned m_phi_fraction_bits;
+	std::vector<int32_t> m_forward;
+	std::vector<int32_t> m_backward;
+};
+
+
+#endif
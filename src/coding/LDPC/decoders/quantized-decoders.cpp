@@ -0,0 +1,227 @@
+#include "decoders.h"
+#include "quantized-kernels.hpp"
+
+#include <iostream>
+#include <cmath>
+
+
+// Every message buffer is padded so that SIMD kernels may read a full register past the last row
+size_t constexpr KERNEL_PADDING{32};
+
+
+template <typename msg_t>
+Eigen::VectorX<GF2> decode_quantized_nms_to_syndrome_impl(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, FixedPointFormat const& format, size_t max_iters, bool verbose)
+{
+	size_t m{static_cast<size_t>(H.rows())};
+	size_t n{static_cast<size_t>(H.cols())};
+	size_t nnz{static_cast<size_t>(H.nonZeros())};
+	int const * outer_index_ptr = H.outerIndexPtr();
+	int const * inner_index_ptr = H.innerIndexPtr();
+
+	int32_t const max_val{(int32_t{1} << (format.bits - 1)) - 1};
+	auto saturate = [max_val](int32_t val) -> msg_t {
+		return static_cast<msg_t>(std::clamp(val, -max_val, max_val));
+	};
+
+	int32_t const rounding{format.scale_shift ? int32_t{1} << (format.scale_shift - 1) : 0};
+	auto normalize = [&format, rounding](msg_t val) -> msg_t {
+		return static_cast<msg_t>((static_cast<int32_t>(val) * static_cast<int32_t>(format.scale_numerator) + rounding) >> format.scale_shift);
+	};
+
+	std::vector<int32_t> R_q(n);
+	for (size_t i{0}; i < n; ++i) {
+		R_q[i] = saturate(static_cast<int32_t>(std::lround(static_cast<double>(R[i]) * (1 << format.fraction_bits))));
+	}
+
+	std::vector<msg_t> M(nnz + KERNEL_PADDING);
+	std::vector<msg_t> E(nnz + KERNEL_PADDING);
+	std::vector<int32_t> L(n);
+	std::vector<unsigned char> c_bits(n);
+
+	std::vector<int> col_ptr, col_rows;
+	std::tie(col_ptr, col_rows) = make_csc_index(H);
+	auto rows_of = [&col_ptr, &col_rows](size_t i, auto f) {
+		for (int k{col_ptr[i]}; k < col_ptr[i + 1]; ++k) {
+			f(col_rows[k]);
+		}
+	};
+	SyndromeTracker syndrome;
+	syndrome.reset(m, n, s);
+
+	for (size_t e{0}; e < nnz; ++e) {
+		M[e] = static_cast<msg_t>(R_q[inner_index_ptr[e]]);
+	}
+
+	size_t I{0};
+	while(true) {
+
+		if (verbose) {
+			std::cout << "Iteration " << I << ":\n";
+		}
+
+		for (size_t j{0}; j < m; ++j) {
+			size_t row_begin = outer_index_ptr[j];
+			size_t d = outer_index_ptr[j + 1] - row_begin;
+			if (!d) {
+				continue;
+			}
+
+			CheckNodeMins<msg_t> mins{check_node_mins(M.data() + row_begin, d)};
+			msg_t min_1 = normalize(mins.min_1);
+			msg_t min_2 = normalize(mins.min_2);
+			bool row_sign{mins.sign != static_cast<bool>(s[j])};
+
+			for (size_t k{0}; k < d; ++k) {
+				msg_t val = (k == mins.min_1_pos) ? min_2 : min_1;
+				E[row_begin + k] = (row_sign != (M[row_begin + k] < 0)) ? static_cast<msg_t>(-val) : val;
+			}
+		}
+
+		std::copy(R_q.begin(), R_q.end(), L.begin());
+		for (size_t e{0}; e < nnz; ++e) {
+			L[inner_index_ptr[e]] += E[e];
+		}
+		for (size_t i{0}; i < n; ++i) {
+			c_bits[i] = L[i] < 0; // Hard decision
+			syndrome.set(i, c_bits[i], rows_of);
+		}
+
+		if (verbose) {
+			std::cout << "Hard decision: ";
+			for (unsigned char bit : c_bits) {
+				std::cout << static_cast<int>(bit) << " ";
+			}
+			std::cout << std::endl;
+		}
+
+		if ((I == max_iters) || syndrome.satisfied()) {
+			Eigen::VectorX<GF2> c(n);
+			std::transform(c_bits.begin(), c_bits.end(), c.begin(), [](unsigned char bit) { return GF2{bit != 0}; });
+			return c;
+		}
+
+		for (size_t e{0}; e < nnz; ++e) {
+			M[e] = saturate(L[inner_index_ptr[e]] - E[e]);
+		}
+
+		++I;
+	}
+}
+
+
+Eigen::VectorX<GF2> decode_quantized_nms_to_syndrome(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, FixedPointFormat const& format, size_t max_iters, bool verbose)
+{
+	if (format.bits < 2 || format.bits > 16 || format.fraction_bits >= format.bits || format.scale_shift > 15 || format.scale_numerator > (1u << format.scale_shift)) {
+		throw std::runtime_error{"Invalid fixed-point format"};
+	}
+
+	if (!H.isCompressed()) {
+		Eigen::SparseMatrix<GF2, Eigen::RowMajor> H_compressed{H};
+		H_compressed.makeCompressed();
+		return decode_quantized_nms_to_syndrome(H_compressed, R, s, format, max_iters, verbose);
+	}
+
+	if (format.bits <= 8) {
+		return decode_quantized_nms_to_syndrome_impl<int8_t>(H, R, s, format, max_iters, verbose);
+	}
+	return decode_quantized_nms_to_syndrome_impl<int16_t>(H, R, s, format, max_iters, verbose);
+}
+
+
+Eigen::VectorX<GF2> decode_quantized_sp_to_syndrome(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, std::vector<LLR> const& R, Eigen::VectorX<GF2> const& s, FixedPointFormat const& format, size_t max_iters, bool verbose)
+{
+	FixedPointPhiTable const phi{format.bits, format.fraction_bits};
+
+	if (!H.isCompressed()) {
+		Eigen::SparseMatrix<GF2, Eigen::RowMajor> H_compressed{H};
+		H_compressed.makeCompressed();
+		return decode_quantized_sp_to_syndrome(H_compressed, R, s, format, max_iters, verbose);
+	}
+
+	size_t m{static_cast<size_t>(H.rows())};
+	size_t n{static_cast<size_t>(H.cols())};
+	size_t nnz{static_cast<size_t>(H.nonZeros())};
+	int const * outer_index_ptr = H.outerIndexPtr();
+	int const * inner_index_ptr = H.innerIndexPtr();
+
+	int32_t const max_val{phi.max_value()};
+	auto saturate = [max_val](int32_t val) -> int16_t {
+		return static_cast<int16_t>(std::clamp(val, -max_val, max_val));
+	};
+
+	std::vector<int32_t> R_q(n);
+	for (size_t i{0}; i < n; ++i) {
+		R_q[i] = saturate(static_cast<int32_t>(std::lround(static_cast<double>(R[i]) * (1 << format.fraction_bits))));
+	}
+
+	std::vector<int16_t> M(nnz);
+	std::vector<int32_t> E(nnz);
+	std::vector<int32_t> L(n);
+	std::vector<unsigned char> c_bits(n);
+
+	std::vector<int> col_ptr, col_rows;
+	std::tie(col_ptr, col_rows) = make_csc_index(H);
+	auto rows_of = [&col_ptr, &col_rows](size_t i, auto f) {
+		for (int k{col_ptr[i]}; k < col_ptr[i + 1]; ++k) {
+			f(col_rows[k]);
+		}
+	};
+	SyndromeTracker syndrome;
+	syndrome.reset(m, n, s);
+
+	for (size_t e{0}; e < nnz; ++e) {
+		M[e] = static_cast<int16_t>(R_q[inner_index_ptr[e]]);
+	}
+
+	size_t I{0};
+	while(true) {
+
+		if (verbose) {
+			std::cout << "Iteration " << I << ":\n";
+		}
+
+		// E holds phi(|M|) on the phi grid between the two passes over a row
+		for (size_t j{0}; j < m; ++j) {
+			int32_t phi_sum{0};
+			bool row_sign{static_cast<bool>(s[j])};
+			for (int e{outer_index_ptr[j]}; e < outer_index_ptr[j + 1]; ++e) {
+				E[e] = phi.forward(std::abs(static_cast<int32_t>(M[e])));
+				phi_sum += E[e];
+				row_sign ^= M[e] < 0;
+			}
+			for (int e{outer_index_ptr[j]}; e < outer_index_ptr[j + 1]; ++e) {
+				int32_t val{phi.backward(phi_sum - E[e])};
+				E[e] = (row_sign != (M[e] < 0)) ? -val : val;
+			}
+		}
+
+		std::copy(R_q.begin(), R_q.end(), L.begin());
+		for (size_t e{0}; e < nnz; ++e) {
+			L[inner_index_ptr[e]] += E[e];
+		}
+		for (size_t i{0}; i < n; ++i) {
+			c_bits[i] = L[i] < 0; // Hard decision
+			syndrome.set(i, c_bits[i], rows_of);
+		}
+
+		if (verbose) {
+			std::cout << "Hard decision: ";
+			for (unsigned char bit : c_bits) {
+				std::cout << static_cast<int>(bit) << " ";
+			}
+			std::cout << std::endl;
+		}
+
+		if ((I == max_iters) || syndrome.satisfied()) {
+			Eigen::VectorX<GF2> c(n);
+			std::transform(c_bits.begin(), c_bits.end(), c.begin(), [](unsigned char bit) { return GF2{bit != 0}; });
+			return c;
+		}
+
+		for (size_t e{0}; e < nnz; ++e) {
+			M[e] = saturate(L[inner_index_ptr[e]] - E[e]);
+		}
+
+		++I;
+	}
+}
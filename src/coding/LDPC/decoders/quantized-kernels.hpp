@@ -0,0 +1,155 @@
+#ifndef QUANTIZED_KERNELS_HPP
+#define QUANTIZED_KERNELS_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <algorithm>
+#include <bit>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+
+// Check node state of a min-sum row: two smallest magnitudes, position of the first one and product of signs.
+// Messages are saturated to [-max, max], so taking an absolute value never overflows.
+template <typename T>
+struct CheckNodeMins
+{
+	T min_1;
+	T min_2;
+	size_t min_1_pos;
+	bool sign;
+};
+
+
+template <typename T>
+inline CheckNodeMins<T> check_node_mins_scalar(T const * msg, size_t d)
+{
+	CheckNodeMins<T> res{std::numeric_limits<T>::max(), std::numeric_limits<T>::max(), 0, false};
+	for (size_t k{0}; k < d; ++k) {
+		T beta = static_cast<T>(msg[k] < 0 ? -msg[k] : msg[k]);
+		res.sign ^= msg[k] < 0;
+		if (beta < res.min_1) {
+			res.min_2 = res.min_1;
+			res.min_1 = beta;
+			res.min_1_pos = k;
+		}
+		else if (beta < res.min_2) {
+			res.min_2 = beta;
+		}
+	}
+	return res;
+}
+
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+
+// Merges 8 widened lanes (rest of them valid) into res using PHMINPOSUW twice: for the minimum and for the minimum without it
+inline void check_node_mins_chunk_sse41(__m128i v, size_t rest, size_t offset, CheckNodeMins<int16_t> & res)
+{
+	__m128i const lane_index{_mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7)};
+	__m128i const max_val{_mm_set1_epi16(std::numeric_limits<int16_t>::max())};
+
+	__m128i valid{_mm_cmplt_epi16(lane_index, _mm_set1_epi16(static_cast<int16_t>(rest)))};
+	__m128i beta{_mm_blendv_epi8(max_val, _mm_abs_epi16(v), valid)};
+
+	__m128i first{_mm_minpos_epu16(beta)};
+	int16_t chunk_min_1 = static_cast<int16_t>(_mm_extract_epi16(first, 0));
+	int chunk_pos = _mm_extract_epi16(first, 1) & 7;
+
+	__m128i knocked_out{_mm_or_si128(beta, _mm_and_si128(_mm_cmpeq_epi16(lane_index, _mm_set1_epi16(static_cast<int16_t>(chunk_pos))), max_val))};
+	int16_t chunk_min_2 = static_cast<int16_t>(_mm_extract_epi16(_mm_minpos_epu16(knocked_out), 0));
+
+	if (chunk_min_1 < res.min_1) {
+		res.min_2 = std::min(res.min_1, chunk_min_2);
+		res.min_1 = chunk_min_1;
+		res.min_1_pos = offset + chunk_pos;
+	}
+	else {
+		res.min_2 = std::min(res.min_2, chunk_min_1);
+	}
+}
+
+#endif
+
+
+// Sign product of a row. Buffers must be readable 32 bytes past the row end.
+inline bool check_node_sign(int8_t const * msg, size_t d)
+{
+#if defined(__AVX2__)
+	unsigned parity{0};
+	for (size_t k{0}; k < d; k += 32) {
+		uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(msg + k))));
+		size_t rest{std::min<size_t>(32, d - k)};
+		if (rest < 32) {
+			mask &= (uint32_t{1} << rest) - 1;
+		}
+		parity ^= std::popcount(mask);
+	}
+	return parity & 1;
+#else
+	bool sign{false};
+	for (size_t k{0}; k < d; ++k) {
+		sign ^= msg[k] < 0;
+	}
+	return sign;
+#endif
+}
+
+
+inline bool check_node_sign(int16_t const * msg, size_t d)
+{
+#if defined(__AVX2__)
+	unsigned parity{0};
+	for (size_t k{0}; k < d; k += 16) {
+		uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(msg + k)))) & 0xAAAAAAAAu; // High byte of every lane
+		size_t rest{std::min<size_t>(16, d - k)};
+		if (rest < 16) {
+			mask &= (uint32_t{1} << (2 * rest)) - 1;
+		}
+		parity ^= std::popcount(mask);
+	}
+	return parity & 1;
+#else
+	bool sign{false};
+	for (size_t k{0}; k < d; ++k) {
+		sign ^= msg[k] < 0;
+	}
+	return sign;
+#endif
+}
+
+
+inline CheckNodeMins<int16_t> check_node_mins(int16_t const * msg, size_t d)
+{
+#if defined(__AVX2__) || defined(__SSE4_1__)
+	CheckNodeMins<int16_t> res{std::numeric_limits<int16_t>::max(), std::numeric_limits<int16_t>::max(), 0, check_node_sign(msg, d)};
+	for (size_t k{0}; k < d; k += 8) {
+		check_node_mins_chunk_sse41(_mm_loadu_si128(reinterpret_cast<__m128i const *>(msg + k)), std::min<size_t>(8, d - k), k, res);
+	}
+	return res;
+#else
+	return check_node_mins_scalar(msg, d);
+#endif
+}
+
+
+inline CheckNodeMins<int8_t> check_node_mins(int8_t const * msg, size_t d)
+{
+#if defined(__AVX2__) || defined(__SSE4_1__)
+	CheckNodeMins<int16_t> res{std::numeric_limits<int16_t>::max(), std::numeric_limits<int16_t>::max(), 0, check_node_sign(msg, d)};
+	for (size_t k{0}; k < d; k += 8) {
+		__m128i widened{_mm_cvtepi8_epi16(_mm_loadl_epi64(reinterpret_cast<__m128i const *>(msg + k)))};
+		check_node_mins_chunk_sse41(widened, std::min<size_t>(8, d - k), k, res);
+	}
+	int16_t const max_val{std::numeric_limits<int8_t>::max()};
+	return {static_cast<int8_t>(std::min(res.min_1, max_val)), static_cast<int8_t>(std::min(res.min_2, max_val)), res.min_1_pos, res.sign};
+#else
+	return check_node_mins_scalar(msg, d);
+#endif
+}
+
+
+#endif
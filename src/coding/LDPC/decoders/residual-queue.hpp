@@ -0,0 +1,88 @@
+#ifndef RESIDUAL_QUEUE_H
+#define RESIDUAL_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+// Max-priority queue over keys 0 .. size - 1 (check rows) where the priority of any key can be changed in O(log size).
+// Residual BP keeps the residual of every check row in it and commits the row on top. Buffers keep their capacity
+// across reset(), so after the first frame no allocation happens.
+class ResidualQueue
+{
+public:
+	// All keys present with priority 0
+	void reset(size_t size)
+	{
+		m_heap.resize(size);
+		m_pos.resize(size);
+		m_priority.assign(size, 0.0);
+		for (uint32_t key{0}; key < size; ++key) {
+			m_heap[key] = key;
+			m_pos[key] = key;
+		}
+	}
+
+	void update(uint32_t key, double priority)
+	{
+		double old{m_priority[key]};
+		m_priority[key] = priority;
+		if (priority > old) {
+			sift_up(m_pos[key]);
+		}
+		else {
+			sift_down(m_pos[key]);
+		}
+	}
+
+	uint32_t top() const { return m_heap.front(); }
+	double top_priority() const { return m_priority[m_heap.front()]; }
+	double priority(uint32_t key) const { return m_priority[key]; }
+	size_t size() const { return m_heap.size(); }
+
+private:
+	void swap_nodes(size_t a, size_t b)
+	{
+		std::swap(m_heap[a], m_heap[b]);
+		m_pos[m_heap[a]] = static_cast<uint32_t>(a);
+		m_pos[m_heap[b]] = static_cast<uint32_t>(b);
+	}
+
+	void sift_up(size_t node)
+	{
+		while (node > 0) {
+			size_t parent{(node - 1) / 2};
+			if (m_priority[m_heap[parent]] >= m_priority[m_heap[node]]) {
+				return;
+			}
+			swap_nodes(node, parent);
+			node = parent;
+		}
+	}
+
+	void sift_down(size_t node)
+	{
+		for (;;) {
+			size_t largest{node};
+			for (size_t child : {2 * node + 1, 2 * node + 2}) {
+				if (child < m_heap.size() && m_priority[m_heap[child]] > m_priority[m_heap[largest]]) {
+					largest = child;
+				}
+			}
+			if (largest == node) {
+				return;
+			}
+			swap_nodes(node, largest);
+			node = largest;
+		}
+	}
+
+	std::vector<uint32_t> m_heap; // Keys in heap order
+	std::vector<uint32_t> m_pos; // Heap position of every key
+	std::vector<double> m_priority;
+};
+
+
+#endif
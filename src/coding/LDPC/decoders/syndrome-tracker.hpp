@@ -0,0 +1,55 @@
+#ifndef SYNDROME_TRACKER_H
+#define SYNDROME_TRACKER_H
+
+#include <cstddef>
+#include <vector>
+
+
+// Hard decision of a decoder and parities of all check rows against the target syndrome, updated incrementally:
+// setting a bit to a new value toggles only the rows of that bit, so convergence detection costs O(flips * dv)
+// per iteration instead of O(nnz). Topology is passed to set() as rows_of(i, f), which calls f(j) for every
+// check row j of variable i; this way CSC index arrays and quasi-cyclic block structure are served alike.
+class SyndromeTracker
+{
+public:
+	// All bits zero, so the row parities equal the target syndrome s
+	template <typename Syndrome>
+	void reset(size_t rows, size_t cols, Syndrome const& s)
+	{
+		m_bits.assign(cols, 0);
+		m_parity.resize(rows);
+		m_unsatisfied = 0;
+		for (size_t j{0}; j < rows; ++j) {
+			m_parity[j] = static_cast<bool>(s[j]);
+			m_unsatisfied += m_parity[j];
+		}
+		m_flips = 0;
+	}
+
+	template <typename RowsOf>
+	void set(size_t i, bool bit, RowsOf const& rows_of)
+	{
+		if (static_cast<bool>(m_bits[i]) == bit) {
+			return;
+		}
+		m_bits[i] = bit;
+		++m_flips;
+		rows_of(i, [this](size_t j) {
+			m_parity[j] ^= 1;
+			m_unsatisfied = m_parity[j] ? m_unsatisfied + 1 : m_unsatisfied - 1;
+		});
+	}
+
+	bool satisfied() const { return m_unsatisfied == 0; }
+	size_t unsatisfied() const { return m_unsatisfied; }
+	size_t flips() const { return m_flips; } // Bit flips since reset
+	std::vector<unsigned char> const& bits() const { return m_bits; }
+private:
+	std::vector<unsigned char> m_bits;
+	std::vector<unsigned char> m_parity;
+	size_t m_unsatisfied{0};
+	size_t m_flips{0};
+};
+
+
+#endif
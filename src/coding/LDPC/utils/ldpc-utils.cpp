@@ -1,6 +1,10 @@
 #include "ldpc-utils.hpp"
 #include "5g_bg_shifts.h"
 #include <random>
+#include <map>
+#include <numeric>
+#include <algorithm>
+#include <tuple>
 
 
 MemoryManager::MemoryManager(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, size_t number_of_threads)
@@ -32,6 +36,8 @@ MemoryManager::MemoryManager(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H,
 
 	inner_index_ptr = const_cast<int *>(H.innerIndexPtr());
 	outer_index_ptr = const_cast<int *>(H.outerIndexPtr());
+
+	std::tie(col_ptr, col_rows) = make_csc_index(H);
 }
 
 
@@ -47,6 +53,31 @@ size_t MemoryManager::compute_memory_amount(size_t nnz, size_t number_of_threads
 }
 
 
+auto make_csc_index(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H) -> std::tuple<std::vector<int>, std::vector<int>>
+{
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H_compressed{H};
+	H_compressed.makeCompressed();
+	int const * outer_index_ptr = H_compressed.outerIndexPtr();
+	int const * inner_index_ptr = H_compressed.innerIndexPtr();
+
+	std::vector<int> col_ptr(H.cols() + 1, 0);
+	for (Eigen::Index e{0}; e < H_compressed.nonZeros(); ++e) {
+		++col_ptr[inner_index_ptr[e] + 1];
+	}
+	std::partial_sum(col_ptr.begin(), col_ptr.end(), col_ptr.begin());
+
+	std::vector<int> col_rows(H_compressed.nonZeros());
+	std::vector<int> fill{col_ptr.begin(), col_ptr.end() - 1};
+	for (Eigen::Index j{0}; j < H.rows(); ++j) {
+		for (int e{outer_index_ptr[j]}; e < outer_index_ptr[j + 1]; ++e) {
+			col_rows[fill[inner_index_ptr[e]]++] = j;
+		}
+	}
+
+	return {col_ptr, col_rows};
+}
+
+
 Eigen::SparseMatrix<GF2, Eigen::RowMajor> vec_to_sparse_m(std::vector<std::vector<GF2>> const& vec_repr)
 {
 	std::vector<Eigen::Triplet<GF2>> triplets;
@@ -110,23 +141,53 @@ std::vector<LLR> llrs_by_bits(std::vector<GF2> const& bits, double e, size_t pad
 
 std::mt19937 random_engine;
 
+
+static int select_shift(size_t eye_row, size_t eye_col, BG_type t, size_t Z_c, shift_randomness rnd, std::uniform_int_distribution<> & shift_distribution, std::mt19937 & engine = random_engine)
+{
+	int shift{0};
+	switch (rnd) {
+		case shift_randomness::RANDOM:
+		{
+			shift = shift_distribution(engine);
+			break;
+		}
+		case shift_randomness::NO_RANDOM:
+		{
+			shift = compute_shift(eye_row, eye_col, t, Z_c);
+			break;
+		}
+		case shift_randomness::COMBINE:
+		{
+			try {
+				shift = compute_shift(eye_row, eye_col, t, Z_c);
+			}
+			catch (std::out_of_range exc) {
+				shift = shift_distribution(engine);
+			}
+			break;
+		}
+	}
+	return shift;
+}
+
+// Every base graph entry becomes a Z_c x Z_c identity block, i.e. a QC block with shift 0
 Eigen::SparseMatrix<GF2, Eigen::RowMajor> enhance_from_base(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& BG, size_t Z_c)
 {
-	Eigen::SparseMatrix<GF2> H(BG.rows() * Z_c, BG.cols() * Z_c);
+	std::vector<QCMatrix::Block> blocks;
+	blocks.reserve(BG.nonZeros());
 	for (size_t bg_i{0}; bg_i < BG.rows(); ++bg_i) {
-		for (size_t bg_j{0}; bg_j < BG.cols(); ++bg_j) {
-			if (BG.coeff(bg_i, bg_j)) {
-				for (size_t h_i{bg_i * Z_c}, h_j{bg_j * Z_c}; (h_i <= Z_c * (bg_i + 1) - 1) && (h_j <= Z_c * (bg_j + 1) - 1); ++h_i, ++h_j) {
-					H.coeffRef(h_i, h_j) = 1;
-				}
+		for (Eigen::SparseMatrix<GF2, Eigen::RowMajor>::InnerIterator it{BG, static_cast<Eigen::Index>(bg_i)}; it; ++it) {
+			if (it.value()) {
+				blocks.push_back({bg_i, static_cast<size_t>(it.col()), 0});
 			}
 		}
 	}
-	H.makeCompressed();
-	return H;
+
+	return QCMatrix{static_cast<size_t>(BG.rows()), static_cast<size_t>(BG.cols()), Z_c, std::move(blocks)}.to_sparse();
 }
 
 
+// Rotates every row of each non-zero Z_c x Z_c block left by its shift, touching the non-zeros of H only
 Eigen::SparseMatrix<GF2, Eigen::RowMajor> shift_eyes(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, size_t Z_c, BG_type t, shift_randomness rnd)
 {
 	// Если размеры матрицы не кратны Z_c
@@ -135,49 +196,163 @@ Eigen::SparseMatrix<GF2, Eigen::RowMajor> shift_eyes(Eigen::SparseMatrix<GF2, Ei
 
 	std::uniform_int_distribution<> shift_distribution(0, Z_c - 1);
 
-	Eigen::Matrix<GF2, Eigen::Dynamic, Eigen::Dynamic> H_dense_copy = H;
-
 	// Количество блоков единичных матриц в строках и столбцах
 	size_t eyes_cols{H.cols() / Z_c};
 	size_t eyes_rows{H.rows() / Z_c};
 
+	std::vector<Eigen::Triplet<GF2>> triplets;
+	triplets.reserve(H.nonZeros());
+	std::vector<unsigned char> non_zero_block(eyes_cols);
+	std::vector<int> shifts(eyes_cols);
 	for (size_t eye_row{0}; eye_row < eyes_rows; ++eye_row) {
+		std::fill(non_zero_block.begin(), non_zero_block.end(), 0);
+		for (size_t h_i{eye_row * Z_c}; h_i < (eye_row + 1) * Z_c; ++h_i) {
+			for (Eigen::SparseMatrix<GF2, Eigen::RowMajor>::InnerIterator it{H, static_cast<Eigen::Index>(h_i)}; it; ++it) {
+				if (it.value()) {
+					non_zero_block[it.col() / Z_c] = 1;
+				}
+			}
+		}
+
+		// Shifts are drawn block by block in the order of the dense traversal, so random ones stay reproducible
 		for (size_t eye_col{0}; eye_col < eyes_cols; ++eye_col) {
-			Eigen::Matrix<GF2, Eigen::Dynamic, Eigen::Dynamic> eye_block = H_dense_copy.block(eye_row * Z_c, eye_col * Z_c, Z_c, Z_c);
-			
-			if (!eye_block.isZero()) {
-				int shift{0};
-				switch (rnd) {
-					case shift_randomness::RANDOM:
-					{
-						shift = shift_distribution(random_engine);
-						break;
-					}
-					case shift_randomness::NO_RANDOM:
-					{
-						shift = compute_shift(eye_row, eye_col, t, Z_c);
-						break;
-					}
-					case shift_randomness::COMBINE:
-					{
-						try {
-							shift = compute_shift(eye_row, eye_col, t, Z_c);
-						}
-						catch (std::out_of_range exc) {
-							shift = shift_distribution(random_engine);
-						}
-						break;
-					}
+			if (non_zero_block[eye_col]) {
+				shifts[eye_col] = select_shift(eye_row, eye_col, t, Z_c, rnd, shift_distribution);
+			}
+		}
+
+		for (size_t h_i{eye_row * Z_c}; h_i < (eye_row + 1) * Z_c; ++h_i) {
+			for (Eigen::SparseMatrix<GF2, Eigen::RowMajor>::InnerIterator it{H, static_cast<Eigen::Index>(h_i)}; it; ++it) {
+				if (it.value()) {
+					size_t eye_col = it.col() / Z_c;
+					size_t h_j = eye_col * Z_c + (it.col() % Z_c + Z_c - shifts[eye_col]) % Z_c;
+					triplets.emplace_back(h_i, h_j, GF2{1});
 				}
-				for (size_t i{0}; i < Z_c; ++i) {
-					std::rotate(eye_block.row(i).begin(), eye_block.row(i).begin() + shift, eye_block.row(i).end());
+			}
+		}
+	}
+
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> shifted(H.rows(), H.cols());
+	shifted.setFromTriplets(triplets.begin(), triplets.end());
+	shifted.makeCompressed();
+	return shifted;
+}
+
+
+QCMatrix::QCMatrix(size_t base_rows, size_t base_cols, size_t Z_c, std::vector<Block> blocks) : m_base_rows{base_rows}, m_base_cols{base_cols}, m_Z{Z_c}, m_blocks{std::move(blocks)}
+{
+	if (Z_c == 0) {
+		throw std::range_error{"QCMatrix: Z_c must be positive"};
+	}
+
+	std::sort(m_blocks.begin(), m_blocks.end(), [](Block const& a, Block const& b) { return std::tie(a.row, a.col) < std::tie(b.row, b.col); });
+
+	m_row_ptr.assign(m_base_rows + 1, 0);
+	for (size_t b{0}; b < m_blocks.size(); ++b) {
+		if (m_blocks[b].row >= m_base_rows || m_blocks[b].col >= m_base_cols || m_blocks[b].shift >= m_Z) {
+			throw std::out_of_range{"QCMatrix: block is out of base graph bounds"};
+		}
+		if (b > 0 && m_blocks[b].row == m_blocks[b - 1].row && m_blocks[b].col == m_blocks[b - 1].col) {
+			throw std::runtime_error{"QCMatrix: duplicate block"};
+		}
+		++m_row_ptr[m_blocks[b].row + 1];
+	}
+	std::partial_sum(m_row_ptr.begin(), m_row_ptr.end(), m_row_ptr.begin());
+}
+
+
+// Blocks of a base row are sorted by column and put one entry into each of its Z_c rows,
+// so the compressed row-major arrays are written in order, without triplets or sorting
+Eigen::SparseMatrix<GF2, Eigen::RowMajor> QCMatrix::to_sparse() const
+{
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H(rows(), cols());
+	H.resizeNonZeros(non_zeros());
+	auto * outer{H.outerIndexPtr()};
+	auto * inner{H.innerIndexPtr()};
+	GF2 * values{H.valuePtr()};
+
+	size_t k{0};
+	for (size_t bg_i{0}; bg_i < m_base_rows; ++bg_i) {
+		for (size_t r{0}; r < m_Z; ++r) {
+			outer[bg_i * m_Z + r] = k;
+			for (size_t b{m_row_ptr[bg_i]}; b < m_row_ptr[bg_i + 1]; ++b) {
+				inner[k] = m_blocks[b].col * m_Z + (r + m_Z - m_blocks[b].shift) % m_Z;
+				values[k] = GF2{1};
+				++k;
+			}
+		}
+	}
+	outer[rows()] = k;
+	return H;
+}
+
+
+QCMatrix make_qc_matrix(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& BG, size_t Z_c, BG_type t, shift_randomness rnd)
+{
+	return make_qc_matrix(BG, Z_c, t, rnd, random_engine);
+}
+
+
+QCMatrix make_qc_matrix(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& BG, size_t Z_c, BG_type t, shift_randomness rnd, std::mt19937 & engine)
+{
+	std::uniform_int_distribution<> shift_distribution(0, Z_c - 1);
+
+	// Same traversal order as in shift_eyes, so random shifts are drawn identically
+	std::vector<QCMatrix::Block> blocks;
+	blocks.reserve(BG.nonZeros());
+	for (size_t bg_i{0}; bg_i < static_cast<size_t>(BG.rows()); ++bg_i) {
+		for (Eigen::SparseMatrix<GF2, Eigen::RowMajor>::InnerIterator it{BG, static_cast<Eigen::Index>(bg_i)}; it; ++it) {
+			if (it.value()) {
+				size_t bg_j = it.col();
+				blocks.push_back({bg_i, bg_j, static_cast<size_t>(select_shift(bg_i, bg_j, t, Z_c, rnd, shift_distribution, engine))});
+			}
+		}
+	}
+
+	return {static_cast<size_t>(BG.rows()), static_cast<size_t>(BG.cols()), Z_c, std::move(blocks)};
+}
+
+
+QCMatrix qc_from_sparse(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, size_t Z_c)
+{
+	if (H.cols() % Z_c || H.rows() % Z_c)
+		throw std::range_error{"H matrix size and Z_c value incompatible"};
+
+	size_t base_rows = H.rows() / Z_c;
+	size_t base_cols = H.cols() / Z_c;
+
+	std::vector<QCMatrix::Block> blocks;
+	for (size_t bg_i{0}; bg_i < base_rows; ++bg_i) {
+		std::map<size_t, size_t> row_shifts; // Base column -> shift
+
+		// First row of the block row defines the shifts, the others must agree with it
+		size_t entries_number{0};
+		for (size_t r{0}; r < Z_c; ++r) {
+			for (Eigen::SparseMatrix<GF2, Eigen::RowMajor>::InnerIterator it{H, static_cast<Eigen::Index>(bg_i * Z_c + r)}; it; ++it) {
+				if (!it.value()) {
+					continue;
+				}
+				size_t bg_j = it.col() / Z_c;
+				size_t shift = (r + Z_c - it.col() % Z_c) % Z_c;
+				if (r == 0) {
+					row_shifts[bg_j] = shift;
+				}
+				else if (row_shifts.find(bg_j) == row_shifts.end() || row_shifts[bg_j] != shift) {
+					throw std::runtime_error{"qc_from_sparse: matrix is not quasi-cyclic with given Z_c"};
 				}
-				H_dense_copy.block(eye_row * Z_c, eye_col * Z_c, Z_c, Z_c) = eye_block;
+				++entries_number;
 			}
 		}
+		if (entries_number != row_shifts.size() * Z_c) {
+			throw std::runtime_error{"qc_from_sparse: matrix is not quasi-cyclic with given Z_c"};
+		}
+
+		for (auto [bg_j, shift] : row_shifts) {
+			blocks.push_back({bg_i, bg_j, shift});
+		}
 	}
 
-	return H_dense_copy.sparseView();
+	return {base_rows, base_cols, Z_c, std::move(blocks)};
 }
 
 
@@ -205,30 +380,32 @@ Eigen::SparseMatrix<GF2, Eigen::RowMajor> augmentWithIdentity(Eigen::SparseMatri
 
 int Z_c2iLS(size_t Z_c)
 {
-	for (std::pair<int, std::vector<int>> const& table_row : iLS_table) {
-		if (std::find(table_row.second.begin(), table_row.second.end(), Z_c) != table_row.second.end()) {
-			return table_row.first;
-		}
+	if (Z_c > MAX_Z_C || Z_c_iLS[Z_c] == NO_ILS) {
+		throw std::runtime_error{"Invalid Z_c value"};
 	}
-	throw std::runtime_error{"Invalid Z_c value"};
+	return Z_c_iLS[Z_c];
+}
+
+
+template <size_t ROWS, size_t COLS>
+static int lookup_shift(flat_shift_table_t<ROWS, COLS> const& shift_table, int row_index, int column_index, int iLS)
+{
+	if (row_index < 0 || static_cast<size_t>(row_index) >= ROWS || column_index < 0 || static_cast<size_t>(column_index) >= COLS
+		|| shift_table[row_index][column_index][iLS] == NO_SHIFT) {
+		throw std::out_of_range{"No shift for this base graph entry"};
+	}
+	return shift_table[row_index][column_index][iLS];
 }
 
 
 int compute_shift(int row_index, int column_index, BG_type t, size_t Z_c)
 {
-	shift_table_t shift_table;
-	switch (t) {
-		case BG_type::BG1:
-			shift_table = BG1_shifts;
-			break;
-		case BG_type::BG2:
-			shift_table = BG2_shifts;
-			break;
-		default:
-			throw std::runtime_error{"Invalid matrix type"};
+	if (t != BG_type::BG1 && t != BG_type::BG2) {
+		throw std::runtime_error{"Invalid matrix type"};
 	}
 
 	int iLS{Z_c2iLS(Z_c)};
+	int shift{t == BG_type::BG1 ? lookup_shift(BG1_shifts, row_index, column_index, iLS) : lookup_shift(BG2_shifts, row_index, column_index, iLS)};
 
-	return shift_table[row_index].at(column_index).at(iLS) % Z_c;
+	return shift % Z_c;
 }
\ No newline at end of file
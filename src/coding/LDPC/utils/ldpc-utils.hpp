@@ -4,6 +4,9 @@
 
 #include <Eigen/Core>
 #include <Eigen/Sparse>
+#include <vector>
+#include <tuple>
+#include <random>
 #include "GF2.hpp"
 
 
@@ -63,6 +66,8 @@ public:
 	int * get_inner_index_ptr() const { return inner_index_ptr; }
 	int * get_outer_index_ptr() const {return outer_index_ptr; }
 	Eigen::Index get_non_zeros() const { return non_zeros; }
+	int const * get_col_ptr() const { return col_ptr.data(); } // CSC view of H: rows of column i are col_rows[col_ptr[i]..col_ptr[i + 1])
+	int const * get_col_rows() const { return col_rows.data(); }
 	~MemoryManager();
 private:
 	size_t compute_memory_amount(size_t nnz, size_t number_of_threads);
@@ -72,6 +77,8 @@ private:
 	int * outer_index_ptr{nullptr};
 	Eigen::Index non_zeros{0};
 	char * raw_data{nullptr};
+	std::vector<int> col_ptr;
+	std::vector<int> col_rows;
 };
 
 
@@ -79,8 +86,43 @@ enum class BG_type{BG1, BG2, NOT_5G};
 enum class shift_randomness{RANDOM, NO_RANDOM, COMBINE};
 
 
+// Quasi-cyclic parity-check matrix stored as base graph entries and their circulant shifts.
+// Block with shift s is a Z_c x Z_c identity matrix with every row rotated left by s (as done by shift_eyes),
+// so row r of the block has its non-zero in column (r + Z_c - s) % Z_c.
+class QCMatrix
+{
+public:
+	struct Block
+	{
+		size_t row;
+		size_t col;
+		size_t shift;
+	};
+
+	QCMatrix(size_t base_rows, size_t base_cols, size_t Z_c, std::vector<Block> blocks);
+	size_t base_rows() const { return m_base_rows; }
+	size_t base_cols() const { return m_base_cols; }
+	size_t Z() const { return m_Z; }
+	size_t rows() const { return m_base_rows * m_Z; }
+	size_t cols() const { return m_base_cols * m_Z; }
+	size_t non_zeros() const { return m_blocks.size() * m_Z; }
+	std::vector<Block> const& blocks() const { return m_blocks; } // Sorted by row, then by column
+	std::vector<size_t> const& row_ptr() const { return m_row_ptr; } // Blocks of base row i are [row_ptr[i], row_ptr[i + 1])
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> to_sparse() const;
+private:
+	size_t m_base_rows;
+	size_t m_base_cols;
+	size_t m_Z;
+	std::vector<Block> m_blocks;
+	std::vector<size_t> m_row_ptr;
+};
+
+
 Eigen::SparseMatrix<GF2, Eigen::RowMajor> vec_to_sparse_m(std::vector<std::vector<GF2>> const& vec_repr);
 
+// Column-wise index of H: rows of column i are col_rows[col_ptr[i]], ..., col_rows[col_ptr[i + 1] - 1], ascending
+auto make_csc_index(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H) -> std::tuple<std::vector<int>, std::vector<int>>;
+
 Eigen::SparseMatrix<GF2, Eigen::RowMajor> augment_with_identity(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H);
 
 Eigen::SparseMatrix<GF2, Eigen::RowMajor> augment_with_identity_opt(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H);
@@ -91,6 +133,13 @@ Eigen::SparseMatrix<GF2, Eigen::RowMajor> enhance_from_base(Eigen::SparseMatrix<
 
 Eigen::SparseMatrix<GF2, Eigen::RowMajor> shift_eyes(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, size_t Z_c, BG_type t, shift_randomness rnd = shift_randomness::NO_RANDOM);
 
+QCMatrix make_qc_matrix(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& BG, size_t Z_c, BG_type t, shift_randomness rnd = shift_randomness::NO_RANDOM);
+
+// Same with random shifts drawn from engine instead of the library-wide one, so they can be reproduced from a seed
+QCMatrix make_qc_matrix(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& BG, size_t Z_c, BG_type t, shift_randomness rnd, std::mt19937 & engine);
+
+QCMatrix qc_from_sparse(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, size_t Z_c);
+
 Eigen::SparseMatrix<GF2, Eigen::RowMajor> augmentWithIdentity(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& Hin);
 
 int Z_c2iLS(size_t Z_c);
@@ -0,0 +1,313 @@
+#include "tanner-cycles.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+
+// Tanner graph of a BinarySparseMatrix: variable nodes are columns, check nodes are rows
+class MatrixGraph
+{
+public:
+	explicit MatrixGraph(BinarySparseMatrix const& H) : m_H{H} {}
+	size_t variables() const { return m_H.cols(); }
+	size_t checks() const { return m_H.rows(); }
+
+	template <typename F>
+	void for_each_check(uint32_t v, F && f) const
+	{
+		for (uint32_t c : m_H.col(v)) {
+			f(c);
+		}
+	}
+
+	template <typename F>
+	void for_each_variable(uint32_t c, F && f) const
+	{
+		for (uint32_t v : m_H.row(c)) {
+			f(v);
+		}
+	}
+
+private:
+	BinarySparseMatrix const& m_H;
+};
+
+
+// Lifted Tanner graph of a QCMatrix, never materialized: variable copy t of base column b is node b * Z + t,
+// check copy t of base row r is node r * Z + t
+class QCGraph
+{
+public:
+	explicit QCGraph(QCMatrix const& qc) : m_qc{qc}, m_col_ptr(qc.base_cols() + 1, 0)
+	{
+		for (QCMatrix::Block const& block : qc.blocks()) {
+			++m_col_ptr[block.col + 1];
+		}
+		for (size_t b{0}; b < qc.base_cols(); ++b) {
+			m_col_ptr[b + 1] += m_col_ptr[b];
+		}
+		m_col_blocks.resize(qc.blocks().size());
+		std::vector<size_t> fill(m_col_ptr.begin(), m_col_ptr.end() - 1);
+		for (QCMatrix::Block const& block : qc.blocks()) {
+			m_col_blocks[fill[block.col]++] = block;
+		}
+	}
+
+	size_t variables() const { return m_qc.cols(); }
+	size_t checks() const { return m_qc.rows(); }
+
+	template <typename F>
+	void for_each_check(uint32_t v, F && f) const
+	{
+		size_t const Z{m_qc.Z()};
+		size_t const b{v / Z}, t{v % Z};
+		for (size_t k{m_col_ptr[b]}; k < m_col_ptr[b + 1]; ++k) {
+			f(static_cast<uint32_t>(m_col_blocks[k].row * Z + (t + m_col_blocks[k].shift) % Z));
+		}
+	}
+
+	template <typename F>
+	void for_each_variable(uint32_t c, F && f) const
+	{
+		size_t const Z{m_qc.Z()};
+		size_t const r{c / Z}, t{c % Z};
+		for (size_t k{m_qc.row_ptr()[r]}; k < m_qc.row_ptr()[r + 1]; ++k) {
+			QCMatrix::Block const& block{m_qc.blocks()[k]};
+			f(static_cast<uint32_t>(block.col * Z + (t + Z - block.shift) % Z));
+		}
+	}
+
+private:
+	QCMatrix const& m_qc;
+	std::vector<size_t> m_col_ptr;
+	std::vector<QCMatrix::Block> m_col_blocks;
+};
+
+
+// Simple path of length 2, 3 or 4 from the start variable node: its last node and the nodes in between (c1, v1, c2)
+struct Path
+{
+	uint32_t end;
+	std::array<uint32_t, 3> nodes;
+};
+
+
+template <size_t K>
+bool disjoint(Path const& a, Path const& b)
+{
+	if constexpr (K == 2) {
+		return true; // Different paths to the same end differ in their only check node
+	}
+	else if constexpr (K == 3) {
+		return a.nodes[0] != b.nodes[0] && a.nodes[1] != b.nodes[1];
+	}
+	else {
+		return a.nodes[0] != b.nodes[0] && a.nodes[0] != b.nodes[2] && a.nodes[2] != b.nodes[0] && a.nodes[2] != b.nodes[2]
+			&& a.nodes[1] != b.nodes[1];
+	}
+}
+
+
+// Cycles of length 2K closed by unordered pairs of the paths
+template <size_t K>
+uint64_t count_closing_pairs(std::vector<Path> & paths)
+{
+	std::sort(paths.begin(), paths.end(), [](Path const& a, Path const& b) { return a.end < b.end; });
+	uint64_t cycles{0};
+	for (size_t first{0}, last; first < paths.size(); first = last) {
+		for (last = first + 1; last < paths.size() && paths[last].end == paths[first].end; ++last) {
+		}
+		if constexpr (K == 2) {
+			cycles += (last - first) * (last - first - 1) / 2;
+		}
+		else {
+			for (size_t i{first}; i < last; ++i) {
+				for (size_t j{i + 1}; j < last; ++j) {
+					cycles += disjoint<K>(paths[i], paths[j]);
+				}
+			}
+		}
+	}
+	return cycles;
+}
+
+
+struct ThreadScratch
+{
+	std::vector<Path> paths[3]; // Lengths 2, 3 and 4
+	std::array<uint64_t, 3> cycles{}; // Of lengths 4, 6 and 8
+	std::vector<uint32_t> dist;
+	std::vector<uint32_t> parent;
+	std::vector<uint32_t> queue;
+};
+
+
+// Cycles of lengths 4, 6 and 8 through the start variable node v; with lowest, only the ones whose other
+// variable nodes all have greater indices
+template <typename Graph>
+void count_cycles_from(Graph const& graph, uint32_t v, bool lowest, ThreadScratch & sc)
+{
+	for (std::vector<Path> & paths : sc.paths) {
+		paths.clear();
+	}
+	auto allowed = [v, lowest](uint32_t u) { return u != v && (!lowest || u > v); };
+	graph.for_each_check(v, [&](uint32_t c1) {
+		graph.for_each_variable(c1, [&](uint32_t v1) {
+			if (!allowed(v1)) {
+				return;
+			}
+			sc.paths[0].push_back({v1, {c1, 0, 0}});
+			graph.for_each_check(v1, [&](uint32_t c2) {
+				if (c2 == c1) {
+					return;
+				}
+				sc.paths[1].push_back({c2, {c1, v1, 0}});
+				graph.for_each_variable(c2, [&](uint32_t v2) {
+					if (allowed(v2) && v2 != v1) {
+						sc.paths[2].push_back({v2, {c1, v1, c2}});
+					}
+				});
+			});
+		});
+	});
+	sc.cycles[0] += count_closing_pairs<2>(sc.paths[0]);
+	sc.cycles[1] += count_closing_pairs<3>(sc.paths[1]);
+	sc.cycles[2] += count_closing_pairs<4>(sc.paths[2]);
+}
+
+
+// Length of the shortest cycle seen by breadth-first search from variable node v, searched while shorter than best.
+// The minimum over all variable nodes (or over one per orbit of an automorphism group) is the girth.
+template <typename Graph>
+size_t shortest_cycle_from(Graph const& graph, uint32_t v, size_t best, ThreadScratch & sc)
+{
+	uint32_t constexpr UNSEEN{std::numeric_limits<uint32_t>::max()};
+	size_t const n{graph.variables()};
+	sc.dist.assign(n + graph.checks(), UNSEEN);
+	sc.parent.resize(n + graph.checks());
+	sc.queue.clear();
+
+	// Check nodes are numbered after the variable ones
+	sc.dist[v] = 0;
+	sc.parent[v] = UNSEEN;
+	sc.queue.push_back(v);
+	for (size_t head{0}; head < sc.queue.size(); ++head) {
+		uint32_t u{sc.queue[head]};
+		if (2 * sc.dist[u] + 1 >= best) {
+			break;
+		}
+		auto visit = [&](uint32_t w) {
+			if (w == sc.parent[u]) {
+				return;
+			}
+			if (sc.dist[w] == UNSEEN) {
+				sc.dist[w] = sc.dist[u] + 1;
+				sc.parent[w] = u;
+				sc.queue.push_back(w);
+			}
+			else {
+				best = std::min<size_t>(best, sc.dist[u] + sc.dist[w] + 1);
+			}
+		};
+		if (u < n) {
+			graph.for_each_check(u, [&](uint32_t c) { visit(static_cast<uint32_t>(n + c)); });
+		}
+		else {
+			graph.for_each_variable(static_cast<uint32_t>(u - n), visit);
+		}
+	}
+	return best;
+}
+
+
+// Calls f(scratch, start) for every start in [0, starts_number), the starts shared out to threads_number threads
+template <typename F>
+std::vector<ThreadScratch> for_each_start(size_t starts_number, size_t threads_number, F f)
+{
+	if (threads_number == 0) {
+		throw std::runtime_error{"count_cycles: number of threads must be positive"};
+	}
+	std::vector<ThreadScratch> scratch(threads_number);
+	std::atomic<size_t> next{0};
+	auto work = [&](size_t thread_index) {
+		for (size_t start; (start = next.fetch_add(1, std::memory_order_relaxed)) < starts_number; ) {
+			f(scratch[thread_index], start);
+		}
+	};
+	std::vector<std::thread> threads;
+	for (size_t thread_index{1}; thread_index < threads_number; ++thread_index) {
+		threads.emplace_back(work, thread_index);
+	}
+	work(0);
+	for (std::thread & thread : threads) {
+		thread.join();
+	}
+	return scratch;
+}
+
+
+// start_node maps [0, starts_number) to the start variable nodes, each standing for multiplicity nodes (its orbit)
+template <typename Graph, typename StartNode>
+CycleStats analyse(Graph const& graph, size_t starts_number, StartNode start_node, bool lowest, uint64_t multiplicity, size_t threads_number)
+{
+	std::vector<ThreadScratch> counted{for_each_start(starts_number, threads_number, [&](ThreadScratch & sc, size_t start) {
+		count_cycles_from(graph, start_node(start), lowest, sc);
+	})};
+
+	CycleStats stats;
+	std::array<uint64_t, 3> cycles{};
+	for (ThreadScratch const& sc : counted) {
+		for (size_t k{0}; k < cycles.size(); ++k) {
+			cycles[k] += sc.cycles[k];
+		}
+	}
+	// Without the lowest restriction a cycle of length 2k is met from each of its k variable nodes
+	stats.cycles_4 = cycles[0] * multiplicity / (lowest ? 1 : 2);
+	stats.cycles_6 = cycles[1] * multiplicity / (lowest ? 1 : 3);
+	stats.cycles_8 = cycles[2] * multiplicity / (lowest ? 1 : 4);
+
+	if (stats.cycles_4 || stats.cycles_6 || stats.cycles_8) {
+		stats.girth = stats.cycles_4 ? 4 : stats.cycles_6 ? 6 : 8;
+		return stats;
+	}
+	std::atomic<size_t> best{std::numeric_limits<size_t>::max()};
+	for_each_start(starts_number, threads_number, [&](ThreadScratch & sc, size_t start) {
+		size_t found{shortest_cycle_from(graph, start_node(start), best.load(std::memory_order_relaxed), sc)};
+		for (size_t current{best.load(std::memory_order_relaxed)}; found < current && !best.compare_exchange_weak(current, found); ) {
+		}
+	});
+	stats.girth = best == std::numeric_limits<size_t>::max() ? 0 : best.load();
+	return stats;
+}
+
+}
+
+
+CycleStats count_cycles(BinarySparseMatrix const& H, size_t threads_number)
+{
+	return analyse(MatrixGraph{H}, H.cols(), [](size_t start) { return static_cast<uint32_t>(start); }, true, 1, threads_number);
+}
+
+
+CycleStats count_cycles(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, size_t threads_number)
+{
+	return count_cycles(BinarySparseMatrix{H}, threads_number);
+}
+
+
+CycleStats count_cycles(QCMatrix const& qc, size_t threads_number)
+{
+	if (qc.rows() > std::numeric_limits<uint32_t>::max() || qc.cols() > std::numeric_limits<uint32_t>::max()) {
+		throw std::runtime_error{"count_cycles: matrix exceeds 32-bit indices"};
+	}
+	size_t const Z{qc.Z()};
+	return analyse(QCGraph{qc}, qc.base_cols(), [Z](size_t b) { return static_cast<uint32_t>(b * Z); }, false, Z, threads_number);
+}
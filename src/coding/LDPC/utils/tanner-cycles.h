@@ -0,0 +1,37 @@
+#ifndef TANNER_CYCLES_H
+#define TANNER_CYCLES_H
+
+#include "binary-sparse-matrix.hpp"
+#include "ldpc-utils.hpp"
+
+#include <Eigen/Sparse>
+#include <cstdint>
+
+
+// Girth and numbers of short cycles of the Tanner graph of a parity-check matrix;
+// a cycle of length 2k passes through k variable and k check nodes.
+struct CycleStats
+{
+	size_t girth{0}; // Length of the shortest cycle, 0 for a graph without cycles
+	uint64_t cycles_4{0};
+	uint64_t cycles_6{0};
+	uint64_t cycles_8{0};
+};
+
+
+// Cycles of length 2k are counted by meeting in the middle: from a start variable node all simple paths of length k
+// are enumerated, and pairs of them ending in the same node with no other node in common close a cycle.
+// Start nodes are split among threads_number threads. Girth above 8 is found by breadth-first search from the start nodes.
+
+// Every variable node of H is a start node, counting the cycles whose lowest variable node it is
+CycleStats count_cycles(BinarySparseMatrix const& H, size_t threads_number = 1);
+CycleStats count_cycles(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, size_t threads_number = 1);
+
+// The lifted graph is walked from the base graph: a step through a block with shift s moves from variable copy t
+// to check copy (t + s) % Z_c and back, so a path closes when the alternating sum of its shifts is 0 mod Z_c.
+// Cyclic shifts of all copies map the graph onto itself, so the first copy of every base column is the only start node
+// and the work does not grow with Z_c.
+CycleStats count_cycles(QCMatrix const& qc, size_t threads_number = 1);
+
+
+#endif
@@ -1,7 +1,13 @@
 #include "alist_matrix.h"
+#include "binary-sparse-matrix.hpp"
 #include <Eigen/Eigen>
+#include <algorithm>
+#include <charconv>
 #include <iostream>
 #include <iterator>
+#include <limits>
+#include <span>
+#include <stdexcept>
 
 
 using namespace Eigen;
@@ -211,10 +217,235 @@ SparseMatrix<GF2, RowMajor> alist_to_sparse_matrix(alist_matrix &a_matrix) {
     int index;
     for (int i = 0; i < a_matrix.nCols; i++) {
         for (int j = 0; j < a_matrix.nColSum[i]; j++) {
-            index = i * a_matrix.mRows + j;
+            index = i * a_matrix.nMaxColSum + j;
             ret.insert(a_matrix.nlist[index] - 1, i) = 1;
         }
     }
     ret.makeCompressed();
     return ret;
-}
\ No newline at end of file
+}
+
+
+namespace
+{
+
+size_t constexpr ALIST_CHUNK_SIZE{1 << 16};
+
+
+// Non-negative integers of a text file, parsed by hand from chunks of it
+class AlistReader
+{
+public:
+	explicit AlistReader(std::string const& filename) : m_file{filename, std::ios::binary}, m_buffer(ALIST_CHUNK_SIZE)
+	{
+		if (!m_file) {
+			throw std::runtime_error{"read_alist: file \"" + filename + "\" not found!"};
+		}
+	}
+
+	int next()
+	{
+		int c{skip_spaces()};
+		if (c < '0' || c > '9') {
+			throw std::runtime_error{c == EOF ? "read_alist: unexpected end of file" : "read_alist: unexpected character"};
+		}
+		long long value{0};
+		for (; c >= '0' && c <= '9'; c = peek()) {
+			value = value * 10 + (c - '0');
+			if (value > std::numeric_limits<int>::max()) {
+				throw std::runtime_error{"read_alist: number out of range"};
+			}
+			++m_pos;
+		}
+		return static_cast<int>(value);
+	}
+
+	// Next non-zero integer; zeros pad the lists
+	int next_entry()
+	{
+		int value;
+		while ((value = next()) == 0) {
+		}
+		return value;
+	}
+
+private:
+	int peek()
+	{
+		if (m_pos == m_end) {
+			m_file.read(m_buffer.data(), m_buffer.size());
+			m_pos = 0;
+			m_end = static_cast<size_t>(m_file.gcount());
+			if (m_end == 0) {
+				return EOF;
+			}
+		}
+		return static_cast<unsigned char>(m_buffer[m_pos]);
+	}
+
+	int skip_spaces()
+	{
+		int c{peek()};
+		for (; c == ' ' || c == '\n' || c == '\r' || c == '\t'; c = peek()) {
+			++m_pos;
+		}
+		return c;
+	}
+
+	std::ifstream m_file;
+	std::vector<char> m_buffer;
+	size_t m_pos{0};
+	size_t m_end{0};
+};
+
+
+// Integers written with std::to_chars into a buffer flushed to the file in chunks
+class AlistWriter
+{
+public:
+	explicit AlistWriter(std::string const& filename) : m_file{filename, std::ios::binary | std::ios::trunc}
+	{
+		if (!m_file) {
+			throw std::runtime_error{"write_alist: can't create file \"" + filename + "\""};
+		}
+		m_buffer.reserve(ALIST_CHUNK_SIZE + 32);
+	}
+
+	~AlistWriter() { flush(); }
+
+	// Value followed by a space, or as in the first lines of matrix_to_alist_string by a line break
+	void put(size_t value, char separator = ' ')
+	{
+		char digits[24];
+		char * end{std::to_chars(digits, digits + sizeof(digits), value).ptr};
+		m_buffer.insert(m_buffer.end(), digits, end);
+		m_buffer.push_back(separator);
+		if (m_buffer.size() >= ALIST_CHUNK_SIZE) {
+			flush();
+		}
+	}
+
+	void end_line() { m_buffer.push_back('\n'); }
+
+	void flush()
+	{
+		m_file.write(m_buffer.data(), m_buffer.size());
+		m_buffer.clear();
+	}
+
+	bool good() const { return m_file.good(); }
+
+private:
+	std::ofstream m_file;
+	std::vector<char> m_buffer;
+};
+
+}
+
+
+SparseMatrix<GF2, RowMajor> read_alist_sparse(std::string const& filename)
+{
+	AlistReader reader{filename};
+	int const n_cols{reader.next()};
+	int const m_rows{reader.next()};
+	reader.next(); // Maximal column and row weights are not needed without the padded lists
+	reader.next();
+
+	std::vector<int> col_sums(n_cols);
+	for (int & sum : col_sums) {
+		sum = reader.next();
+	}
+
+	// Row weights give the CSR row offsets, so the column lists are scattered into place as they are read
+	SparseMatrix<GF2, RowMajor> H(m_rows, n_cols);
+	int * row_ptr{H.outerIndexPtr()};
+	for (int j{0}; j < m_rows; ++j) {
+		int const weight{reader.next()};
+		if (weight > std::numeric_limits<int>::max() - row_ptr[j]) {
+			throw std::runtime_error{"read_alist: row weights out of range"};
+		}
+		row_ptr[j + 1] = row_ptr[j] + weight;
+	}
+	H.resizeNonZeros(row_ptr[m_rows]);
+	int * col_indices{H.innerIndexPtr()};
+	std::fill(H.valuePtr(), H.valuePtr() + H.nonZeros(), GF2{1});
+
+	std::vector<int> fill(row_ptr, row_ptr + m_rows);
+	for (int i{0}; i < n_cols; ++i) {
+		for (int k{0}; k < col_sums[i]; ++k) {
+			int row{reader.next_entry() - 1};
+			if (row >= m_rows || fill[row] == row_ptr[row + 1] || (fill[row] > row_ptr[row] && col_indices[fill[row] - 1] == i)) {
+				throw std::runtime_error{"read_alist: column lists disagree with row weights"};
+			}
+			col_indices[fill[row]++] = i;
+		}
+	}
+	for (int j{0}; j < m_rows; ++j) {
+		if (fill[j] != row_ptr[j + 1]) {
+			throw std::runtime_error{"read_alist: column lists disagree with row weights"};
+		}
+	}
+
+	// Columns were visited in order, so every row is sorted and the row lists are looked up in it;
+	// a row list has as many entries as the row, so with no repeats it names every column of the row
+	std::vector<int> last_row(n_cols, -1);
+	for (int j{0}; j < m_rows; ++j) {
+		for (int k{row_ptr[j]}; k < row_ptr[j + 1]; ++k) {
+			int col{reader.next_entry() - 1};
+			if (!std::binary_search(col_indices + row_ptr[j], col_indices + row_ptr[j + 1], col) || last_row[col] == j) {
+				throw std::runtime_error{"read_alist: row lists disagree with column lists"};
+			}
+			last_row[col] = j;
+		}
+	}
+	return H;
+}
+
+
+void write_alist_sparse(SparseMatrix<GF2, RowMajor> const& H, std::string const& filename)
+{
+	BinarySparseMatrix const B{H};
+	std::vector<uint32_t> const& row_ptr{B.row_ptr()};
+	std::vector<uint32_t> const& col_ptr{B.col_ptr()};
+	size_t max_col_sum{0}, max_row_sum{0};
+	for (size_t i{0}; i < B.cols(); ++i) {
+		max_col_sum = std::max<size_t>(max_col_sum, col_ptr[i + 1] - col_ptr[i]);
+	}
+	for (size_t j{0}; j < B.rows(); ++j) {
+		max_row_sum = std::max<size_t>(max_row_sum, row_ptr[j + 1] - row_ptr[j]);
+	}
+
+	AlistWriter writer{filename};
+	auto put_line = [&writer](std::span<uint32_t const> entries, size_t width) {
+		for (uint32_t entry : entries) {
+			writer.put(entry + 1);
+		}
+		for (size_t k{entries.size()}; k < width; ++k) {
+			writer.put(0);
+		}
+		writer.end_line();
+	};
+
+	writer.put(B.cols());
+	writer.put(B.rows(), '\n');
+	writer.put(max_col_sum);
+	writer.put(max_row_sum, '\n');
+	for (size_t i{0}; i < B.cols(); ++i) {
+		writer.put(col_ptr[i + 1] - col_ptr[i]);
+	}
+	writer.end_line();
+	for (size_t j{0}; j < B.rows(); ++j) {
+		writer.put(row_ptr[j + 1] - row_ptr[j]);
+	}
+	writer.end_line();
+	for (size_t i{0}; i < B.cols(); ++i) {
+		put_line(B.col(i), max_col_sum);
+	}
+	for (size_t j{0}; j < B.rows(); ++j) {
+		put_line(B.row(j), max_row_sum);
+	}
+	writer.flush();
+	if (!writer.good()) {
+		throw std::runtime_error{"write_alist: writing \"" + filename + "\" failed"};
+	}
+}
@@ -67,5 +67,13 @@ Eigen::Matrix<GF2, Eigen::Dynamic, Eigen::Dynamic> alist_to_matrix(
 
 Eigen::SparseMatrix<GF2, Eigen::RowMajor> alist_to_sparse_matrix(alist_matrix &a_matrix);
 
+// Streaming alist input and output: the file is read or written in chunks straight from or to the compressed
+// matrix, without the padded lists of alist_matrix or a dense copy. The reader checks the row lists against the
+// column lists and throws std::runtime_error on malformed files; zeros inside the lists are skipped as padding.
+Eigen::SparseMatrix<GF2, Eigen::RowMajor> read_alist_sparse(std::string const &filename);
+
+void write_alist_sparse(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const &H,
+                        std::string const &filename);
+
 
 #endif
\ No newline at end of file
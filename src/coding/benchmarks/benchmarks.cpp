@@ -1,5 +1,7 @@
 #include "benchmarks.h"
 #include "file-processor.h"
+#include "matrix-file.h"
+#include "lifted-matrix-cache.h"
 #include "efrinv.hpp"
 
 #include <random>
@@ -119,28 +121,46 @@ double estimate_ber_by_exposed(Eigen::Vector<GF2, Eigen::Dynamic> const &codewor
 namespace benchmarks
 {
 
+auto reconcile(DecoderContext const& ctx, size_t thread_index, DecoderChain const& chain, std::vector<LLR> const& llrs, BitVector const& syndrome, BitVector & out) -> ReconciliationStats
+{
+	if (chain.fallback && chain.fallback->params.warm_start && chain.fallback->params.precision != chain.first.params.precision) {
+		throw std::runtime_error{"Warm-started fallback decoder must use the message precision of the first one"};
+	}
+	DecodingStats first{decode_to_syndrome_into(ctx, thread_index, chain.first.alg_type, llrs, syndrome, out, chain.first.params)};
+	if (first.converged || !chain.fallback) {
+		return {first.converged, false, first.iterations};
+	}
+	DecodingStats fallback{decode_to_syndrome_into(ctx, thread_index, chain.fallback->alg_type, llrs, syndrome, out, chain.fallback->params)};
+	return {fallback.converged, true, first.iterations + fallback.iterations};
+}
+
+
 BaseBenchmark::BaseBenchmark(std::string const& H_name, BG_type bg_type, size_t bg_rows, size_t bg_cols, size_t Z) : m_Z{Z}
 {
-	m_H = load_matrix_from_alist(H_name);
+	m_decoder_params.layer_size = Z;
+	m_H = load_matrix(H_name);
 	size_t m = m_H.rows();
 	size_t n = m_H.cols();
 
 	if (bg_type != BG_type::NOT_5G) {
-		Eigen::SparseMatrix<GF2, Eigen::RowMajor> new_H{m_H.block(0, 0, bg_rows, bg_cols)};
-		new_H = enhance_from_base(new_H, Z);
-		new_H = shift_eyes(new_H, Z, bg_type);
-		m_H = new_H;
+		Eigen::SparseMatrix<GF2, Eigen::RowMajor> bg{m_H.block(0, 0, bg_rows, bg_cols)};
+		m_H = s_lifting_cache_directory ? LiftedMatrixCache{*s_lifting_cache_directory}.lift(bg, Z, bg_type) : make_qc_matrix(bg, Z, bg_type).to_sparse();
 	}
+	prepare_decoder_context();
+	update_decoder_chains();
 }
 
 
-BaseBenchmark::BaseBenchmark(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H) : m_H{H} {}
+BaseBenchmark::BaseBenchmark(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H) : m_H{H}
+{
+	prepare_decoder_context();
+	update_decoder_chains();
+}
 
 
-auto BaseBenchmark::gen_rand_bit_seq(size_t len) -> Eigen::Vector<GF2, Eigen::Dynamic> const
+auto BaseBenchmark::gen_rand_bit_seq(size_t len) -> BitVector const
 {
-	Eigen::Vector<GF2, Eigen::Dynamic> result(len);
-	std::uniform_int_distribution<> bitDistribution{0, 1};
+	BitVector result(len);
 
 	#ifdef DEBUG
 	size_t seed{std::chrono::steady_clock::now().time_since_epoch().count()};
@@ -149,17 +169,38 @@ auto BaseBenchmark::gen_rand_bit_seq(size_t len) -> Eigen::Vector<GF2, Eigen::Dy
 	// size_t seed{0};
 	#endif
 
-	std::mt19937 random_engine;
+	std::mt19937_64 random_engine;
 	random_engine.seed(seed);
 
-	for (GF2& bit : result) {
-		bit = bitDistribution(random_engine);
-	}
+	result.randomize(random_engine);
 
 	return result;
 }
 
 
+void BaseBenchmark::prepare_decoder_context()
+{
+	m_decoder_ctx = std::make_unique<DecoderContext>(m_H, THREADS_NUMBER); // Edge-sized scratch is allocated by the threads that decode
+}
+
+
+void BaseBenchmark::update_decoder_chains()
+{
+	for (size_t alg{0}; alg < m_decoder_chains.size(); ++alg) {
+		m_decoder_chains[alg] = {{static_cast<LDPC_algo>(alg), m_decoder_params}, m_fallback};
+	}
+}
+
+
+auto BaseBenchmark::decoder_context(size_t thread_index) const -> DecoderContext const&
+{
+	if (thread_index >= m_decoder_ctx->threads_number()) {
+		throw std::runtime_error{"Benchmark decoder context has no scratch for thread " + std::to_string(thread_index)};
+	}
+	return *m_decoder_ctx;
+}
+
+
 // auto BaseBenchmark::run(double ber_start, double ber_stop, double ber_step, LDPC_algo alg_type, bool verbose) -> RunningResult const
 // {
 // 	size_t constexpr STAT_ITERATIONS{30};
@@ -282,7 +323,7 @@ auto BaseBenchmark::compute_one_point(double ber, LDPC_algo alg_type, MemoryMana
 
 auto BaseBenchmark::run(double ber_start, double ber_stop, double ber_step, LDPC_algo alg_type, bool verbose) -> RunningResult const
 {
-	size_t constexpr STAT_ITERATIONS{30}; // 100
+	size_t constexpr STAT_ITERATIONS{THREADS_NUMBER}; // Each on its own decoder scratch
 
 	std::vector<double> fers;
 	std::vector<double> fer_std_devs;
@@ -318,7 +359,7 @@ auto BaseBenchmark::find_intersection(double ber_start, double ber_stop, double
         throw std::runtime_error{"Invalid BER parameters"};
     }
 
-	size_t constexpr STAT_ITERATIONS{30}; // 100
+	size_t constexpr STAT_ITERATIONS{THREADS_NUMBER}; // Each on its own decoder scratch
     double left{ber_start};
     double right{ber_stop};
 	MemoryManager mm{m_H, STAT_ITERATIONS};
@@ -356,6 +397,7 @@ void BaseBenchmark::change_m_H(std::vector<std::pair<int, int>> changes) {
 	for (auto [row, col] : changes) {
 		this->m_H.coeff(row, col) = this->m_H.coeff(row, col) + GF2(1);
 	}
+	prepare_decoder_context();
 }
 
 auto ClassicEC::perform_error_correction(double ber, LDPC_algo alg_type, MemoryManager const& mm, size_t thread_index) -> bool const
@@ -370,36 +412,13 @@ auto ClassicEC::perform_error_correction(double ber, LDPC_algo alg_type, MemoryM
 
 	std::vector<LLR> llrs{compute_llrs(received_data, ber)};
 
-	size_t constexpr DECODING_ITERS_NUMBER{30}; // 50
-	
-	switch (alg_type) {
-		case LDPC_algo::SP:
-			if (decode_sum_product_opt(m_H, llrs, DECODING_ITERS_NUMBER) == message) {
-				return true;
-			}
-			break;
-		case LDPC_algo::MS:
-			if (decode_normalized_min_sum_opt(m_H, llrs, 1.0, DECODING_ITERS_NUMBER) == message) {
-				return true;
-			}
-			break;
-		case LDPC_algo::NMS:
-			if (decode_normalized_min_sum_opt(m_H, llrs, 0.75, DECODING_ITERS_NUMBER) == message) {
-				return true;
-			}
-			break;
-		case LDPC_algo::LMS:
-			if (decode_layered_normalized_min_sum(m_H, llrs, m_Z, 1.0, DECODING_ITERS_NUMBER) == message) {
-				return true;
-			}
-			break;
-		case LDPC_algo::LNMS:
-			if (decode_layered_normalized_min_sum(m_H, llrs, m_Z, 0.75, DECODING_ITERS_NUMBER) == message) {
-				return true;
-			}
-			break;
-		default:
-			throw std::runtime_error{"Invalid LDPC algorithm for ClassicEC benchmark"};
+	if (m_fallback) {
+		BitVector decoded(m_H.cols());
+		reconcile(decoder_context(thread_index), thread_index, decoder_chain(alg_type), llrs, BitVector(m_H.rows()), decoded);
+		return decoded == BitVector{codeword};
+	}
+	if (decode(decoder_context(thread_index), thread_index, alg_type, llrs, m_decoder_params) == message) {
+		return true;
 	}
 	return false;
 }
@@ -494,46 +513,60 @@ auto BIAWGNChannellEC::ber_to_sigma(double ber) -> double const
 
 auto WynersEC::perform_error_correction(double ber, LDPC_algo alg_type, MemoryManager const& mm, size_t thread_index) -> bool const
 {
-	Eigen::Vector<GF2, Eigen::Dynamic> message{gen_rand_bit_seq(m_H.cols())};
+	BitVector message{gen_rand_bit_seq(m_H.cols())};
 
-	Eigen::Vector<GF2, Eigen::Dynamic> syndrome{m_H * message};
+	BitVector syndrome{::syndrome(decoder_context(thread_index).H(), message)};
 
-	Eigen::Vector<double, Eigen::Dynamic> received_data{add_errors(message, ber)};
+	Eigen::Vector<double, Eigen::Dynamic> received_data{add_errors(message.to_eigen(), ber)};
 
 	std::vector<LLR> llrs{compute_llrs(received_data, ber)};
 
-	size_t constexpr DECODING_ITERS_NUMBER{30}; // 50
-	
+	BitVector decoded(m_H.cols());
+	if (m_fallback) {
+		reconcile(decoder_context(thread_index), thread_index, decoder_chain(alg_type), llrs, syndrome, decoded);
+		return decoded == message;
+	}
+
+	decode_to_syndrome_into(decoder_context(thread_index), thread_index, alg_type, llrs, syndrome, decoded, m_decoder_params);
+	return decoded == message;
+}
+
+
+auto WynersEC::perform_error_correction_batch(double ber, LDPC_algo alg_type, size_t frames_number) -> size_t const
+{
+	double scale{0.0};
 	switch (alg_type) {
-		case LDPC_algo::SP:
-			if (decode_sp_to_syndrome(m_H, llrs, syndrome, DECODING_ITERS_NUMBER) == message) {
-				return true;
-			}
-			break;
 		case LDPC_algo::MS:
-			if (decode_nms_to_syndrome_r(m_H, llrs, syndrome, mm, thread_index, 1.0, DECODING_ITERS_NUMBER) == message) {
-				return true;
-			}
+			scale = 1.0;
 			break;
 		case LDPC_algo::NMS:
-			if (decode_nms_to_syndrome_r(m_H, llrs, syndrome, mm, thread_index, 0.75, DECODING_ITERS_NUMBER) == message) {
-				return true;
-			}
-			break;
-		case LDPC_algo::LMS:
-			if (decode_lnms_to_syndrome(m_H, llrs, syndrome, m_Z, 1.0, DECODING_ITERS_NUMBER) == message) {
-				return true;
-			}
-			break;
-		case LDPC_algo::LNMS:
-			if (decode_lnms_to_syndrome(m_H, llrs, syndrome, m_Z, 0.75, DECODING_ITERS_NUMBER) == message) {
-				return true;
-			}
+			scale = m_decoder_params.scale;
 			break;
 		default:
-			throw std::runtime_error{"Invalid LDPC algorithm for WynersEC benchmark"};
+			throw std::runtime_error{"Invalid LDPC algorithm for WynersEC batch decoding"};
 	}
-	return false;
+
+	std::vector<BitVector> messages;
+	std::vector<Eigen::VectorX<GF2>> syndromes;
+	std::vector<std::vector<LLR>> llrs;
+	messages.reserve(frames_number);
+	syndromes.reserve(frames_number);
+	llrs.reserve(frames_number);
+
+	BinarySparseMatrix const& H{decoder_context(0).H()};
+	for (size_t frame{0}; frame < frames_number; ++frame) {
+		messages.push_back(gen_rand_bit_seq(m_H.cols()));
+		syndromes.push_back(::syndrome(H, messages.back()).to_eigen()); // Batch decoder takes unpacked syndromes
+		llrs.push_back(compute_llrs(add_errors(messages.back().to_eigen(), ber), ber));
+	}
+
+	std::vector<BatchDecodingResult> results{decode_nms_to_syndrome_batch(m_H, llrs, syndromes, scale, m_decoder_params.max_iters)};
+
+	size_t corrected{0};
+	for (size_t frame{0}; frame < frames_number; ++frame) {
+		corrected += BitVector{results[frame].word} == messages[frame];
+	}
+	return corrected;
 }
 
 
@@ -719,7 +752,7 @@ std::pair<double, double> compute_mean_and_std(std::vector<double> const& values
 
 auto ExposedBUSChannellWynersEC::run(BenchmarkRange ber_range, BenchmarkRange exposed_rate_range, LDPC_algo alg_type, bool verbose) -> ExposedRunningResult const
 {
-    size_t constexpr STAT_ITERATIONS{30}; // 100
+    size_t constexpr STAT_ITERATIONS{THREADS_NUMBER}; // Each on its own decoder scratch
     size_t constexpr MAX_FAILURES{50}; // 100
     size_t constexpr MAX_DECODINGS{2000}; // 10000
     size_t constexpr SUB_THREADS_NUMBER{3}; // 3
@@ -818,47 +851,24 @@ auto ExposedBUSChannellWynersEC::run(BenchmarkRange ber_range, BenchmarkRange ex
 
 auto ExposedBUSChannellWynersEC::perform_error_correction(double ber, double exposed_bits_rate, LDPC_algo alg_type, double &estimated_ber, MemoryManager const& mm, size_t thread_index) -> bool const
 {
-        Eigen::Vector<GF2, Eigen::Dynamic> message{gen_rand_bit_seq(m_H.cols())};
+        BitVector message{gen_rand_bit_seq(m_H.cols())};
 
-        Eigen::Vector<GF2, Eigen::Dynamic> syndrome{m_H * message};
+        BitVector syndrome{::syndrome(decoder_context(thread_index).H(), message)};
 
-        Eigen::Vector<double, Eigen::Dynamic> received_data{add_errors(message, ber)};
+        Eigen::Vector<GF2, Eigen::Dynamic> codeword{message.to_eigen()};
+        Eigen::Vector<double, Eigen::Dynamic> received_data{add_errors(codeword, ber)};
 
-        estimated_ber = estimate_ber_by_exposed(message, received_data, exposed_bits_rate);
+        estimated_ber = estimate_ber_by_exposed(codeword, received_data, exposed_bits_rate);
         std::vector<LLR> llrs{compute_llrs(received_data, estimated_ber)};
 
-        size_t constexpr DECODING_ITERS_NUMBER{30}; // 50
-
-        switch (alg_type) {
-			case LDPC_algo::SP:
-				if (decode_sp_to_syndrome(m_H, llrs, syndrome, DECODING_ITERS_NUMBER) == message) {
-					return true;
-				}
-				break;
-			case LDPC_algo::MS:
-				if (decode_nms_to_syndrome_r(m_H, llrs, syndrome, mm, thread_index, 1.0, DECODING_ITERS_NUMBER) == message) {
-					return true;
-				}
-				break;
-			case LDPC_algo::NMS:
-				if (decode_nms_to_syndrome_r(m_H, llrs, syndrome, mm, thread_index, 0.75, DECODING_ITERS_NUMBER) == message) {
-					return true;
-				}
-				break;
-			case LDPC_algo::LMS:
-				if (decode_lnms_to_syndrome(m_H, llrs, syndrome, m_Z, 1.0, DECODING_ITERS_NUMBER) == message) {
-					return true;
-				}
-				break;
-			case LDPC_algo::LNMS:
-				if (decode_lnms_to_syndrome(m_H, llrs, syndrome, m_Z, 0.75, DECODING_ITERS_NUMBER) == message) {
-					return true;
-				}
-				break;
-            default:
-                throw std::runtime_error{"Invalid LDPC algorithm for WynersEC benchmark"};
+        BitVector decoded(m_H.cols());
+        if (m_fallback) {
+            reconcile(decoder_context(thread_index), thread_index, decoder_chain(alg_type), llrs, syndrome, decoded);
+            return decoded == message;
         }
-        return false;
+
+        decode_to_syndrome_into(decoder_context(thread_index), thread_index, alg_type, llrs, syndrome, decoded, m_decoder_params);
+        return decoded == message;
 }
 
 
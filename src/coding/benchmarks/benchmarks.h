@@ -8,11 +8,42 @@
 #include <mutex>
 #include <array>
 #include <map>
+#include <optional>
+#include <memory>
+#include <filesystem>
 
 
 namespace benchmarks 
 {
 
+struct DecoderStage
+{
+	LDPC_algo alg_type;
+	DecoderParams params;
+};
+
+
+// Decoder-chain policy of reconciliation: frames whose syndrome check fails after the first (cheap) stage are
+// decoded again by the fallback one; with warm_start in its params it continues from the first stage's messages,
+// which needs the precision of both stages to be the same.
+struct DecoderChain
+{
+	DecoderStage first;
+	std::optional<DecoderStage> fallback;
+};
+
+
+struct ReconciliationStats
+{
+	bool converged;
+	bool fallback_used;
+	size_t iterations; // Of both stages
+};
+
+
+auto reconcile(DecoderContext const& ctx, size_t thread_index, DecoderChain const& chain, std::vector<LLR> const& llrs, BitVector const& syndrome, BitVector & out) -> ReconciliationStats;
+
+
 class BaseBenchmark
 {
 public:
@@ -23,22 +54,37 @@ public:
 		std::vector<double> fer_std_devs;
 	};
 
+	static size_t constexpr THREADS_NUMBER{30}; // Concurrent perform_error_correction calls of run() and find_intersection(), thread_index below it
+
 	BaseBenchmark(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H);
 	BaseBenchmark(std::string const& H_name, BG_type bg_type, size_t bg_rows, size_t bg_cols, size_t Z);
 	auto run(double ber_start, double ber_stop, double ber_step, LDPC_algo alg_type, bool verbose) -> RunningResult const;
 	auto virtual perform_error_correction(double ber, LDPC_algo alg_type, MemoryManager const& mm, size_t thread_index) -> bool const = 0;
 	auto find_intersection(double ber_start, double ber_stop, double ber_prec, double threshold, LDPC_algo alg_type, bool verbose) -> double const;
 	void change_m_H(std::vector<std::pair<int, int>> changes);
+	void set_decoder_params(DecoderParams const& params) { m_decoder_params = params; update_decoder_chains(); } // layer_size included
+	auto decoder_params() const -> DecoderParams const& { return m_decoder_params; }
+	void set_fallback_decoder(std::optional<DecoderStage> fallback) { m_fallback = std::move(fallback); update_decoder_chains(); } // Second stage of perform_error_correction
+	auto decoder_chain(LDPC_algo alg_type) const -> DecoderChain const& { return m_decoder_chains[static_cast<size_t>(alg_type)]; }
+	static void set_lifting_cache_directory(std::optional<std::filesystem::path> directory) { s_lifting_cache_directory = std::move(directory); } // For benchmarks constructed afterwards
 
 protected:
 	auto virtual compute_llrs(Eigen::Vector<double, Eigen::Dynamic> const& received_data, double ber) -> std::vector<LLR> const = 0;
 	auto virtual add_errors(Eigen::Vector<GF2, Eigen::Dynamic> const& codeword, double ber) -> Eigen::Vector<double, Eigen::Dynamic> const = 0;
-	auto gen_rand_bit_seq(size_t len) -> Eigen::Vector<GF2, Eigen::Dynamic> const;
+	auto gen_rand_bit_seq(size_t len) -> BitVector const;
+	void prepare_decoder_context(); // Rebuilds the context of m_H, never while frames are decoded on it
+	auto decoder_context(size_t thread_index) const -> DecoderContext const&; // Throws for thread_index of THREADS_NUMBER and above
 
 	Eigen::SparseMatrix<GF2, Eigen::RowMajor> m_H;
-	size_t m_Z;
+	std::unique_ptr<DecoderContext> m_decoder_ctx; // Topology of m_H with scratch for THREADS_NUMBER threads, built with m_H
+	size_t m_Z{1};
+	DecoderParams m_decoder_params{.scale = 0.75, .offset = 0.5, .max_iters = 30}; // Layer size is Z for lifted matrices
+	std::optional<DecoderStage> m_fallback; // Without it frames are decoded by alg_type with m_decoder_params only
+	std::array<DecoderChain, static_cast<size_t>(LDPC_algo::RNMS) + 1> m_decoder_chains; // Per first-stage algorithm, so frames do not copy the params
+	inline static std::optional<std::filesystem::path> s_lifting_cache_directory; // LiftedMatrixCache of 5G liftings, none by default
 
 private:
+	void update_decoder_chains();
 	auto compute_one_point(double ber, LDPC_algo alg_type, MemoryManager const& mm, size_t const STAT_ITERATIONS, bool verbose) -> std::pair<double, double>;
 };
 
@@ -82,6 +128,7 @@ public:
 	WynersEC(std::string const& H_name, BG_type bg_type, size_t bg_rows, size_t bg_cols, size_t Z) : BaseBenchmark{H_name, bg_type, bg_rows, bg_cols, Z} {}
 	WynersEC(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H) : BaseBenchmark{H} {}
 	auto perform_error_correction(double ber, LDPC_algo alg_type, MemoryManager const& mm, size_t thread_index) -> bool const override;
+	auto perform_error_correction_batch(double ber, LDPC_algo alg_type, size_t frames_number) -> size_t const; // Returns number of corrected frames
 };
 
 
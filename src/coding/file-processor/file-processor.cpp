@@ -8,12 +8,7 @@
 
 void dump_matrix(Eigen::SparseMatrix<GF2> const& m, std::string const& filename)
 {
-	Eigen::Matrix<GF2, Eigen::Dynamic, Eigen::Dynamic> m_dense = m.toDense();
-	std::string m_str = matrix_to_alist_string(m_dense);
-
-	std::ofstream m_file{filename};
-	m_file << m_str;
-	m_file.close();
+	write_alist_sparse(Eigen::SparseMatrix<GF2, Eigen::RowMajor>{m}, filename);
 }
 
 void dump_current_matrix(Eigen::SparseMatrix<GF2> const& m, size_t opt_rows, size_t opt_cols)
@@ -40,7 +35,5 @@ void dump_current_matrix(Eigen::SparseMatrix<GF2> const& m, size_t opt_rows, siz
 
 Eigen::SparseMatrix<GF2> load_matrix_from_alist(std::string const& filename)
 {
-	alist_matrix matrix_alist;
-	read_alist(filename, matrix_alist);
-	return alist_to_matrix(matrix_alist).sparseView();
+	return read_alist_sparse(filename);
 }
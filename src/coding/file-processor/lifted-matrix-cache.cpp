@@ -0,0 +1,92 @@
+#include "lifted-matrix-cache.h"
+#include "matrix-file.h"
+
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+
+namespace
+{
+
+// FNV-1a over the bytes of 64-bit words
+class KeyHash
+{
+public:
+	void add(uint64_t word)
+	{
+		for (size_t byte{0}; byte < sizeof(word); ++byte) {
+			m_hash = (m_hash ^ ((word >> (8 * byte)) & 0xff)) * 0x100000001b3;
+		}
+	}
+	uint64_t value() const { return m_hash; }
+private:
+	uint64_t m_hash{0xcbf29ce484222325};
+};
+
+}
+
+
+LiftedMatrixCache::LiftedMatrixCache(std::filesystem::path directory) : m_directory{std::move(directory)}
+{
+	std::filesystem::create_directories(m_directory);
+}
+
+
+std::filesystem::path LiftedMatrixCache::path(uint64_t key) const
+{
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.ldpcm", static_cast<unsigned long long>(key));
+	return m_directory / name;
+}
+
+
+uint64_t LiftedMatrixCache::key(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& BG, size_t Z_c, BG_type t, shift_randomness rnd, uint64_t seed)
+{
+	KeyHash hash;
+	hash.add(MATRIX_FILE_VERSION);
+	hash.add(BG.rows());
+	hash.add(BG.cols());
+	for (Eigen::Index bg_i{0}; bg_i < BG.outerSize(); ++bg_i) {
+		for (Eigen::SparseMatrix<GF2, Eigen::RowMajor>::InnerIterator it{BG, bg_i}; it; ++it) {
+			if (it.value()) {
+				hash.add(static_cast<uint64_t>(bg_i) << 32 | static_cast<uint64_t>(it.col()));
+			}
+		}
+	}
+	hash.add(Z_c);
+	hash.add(static_cast<uint64_t>(t));
+	hash.add(static_cast<uint64_t>(rnd));
+	hash.add(rnd == shift_randomness::NO_RANDOM ? 0 : seed);
+	return hash.value() == 0 ? 1 : hash.value(); // 0 marks files outside the cache
+}
+
+
+Eigen::SparseMatrix<GF2, Eigen::RowMajor> LiftedMatrixCache::lift(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& BG, size_t Z_c, BG_type t,
+	shift_randomness rnd, uint64_t seed) const
+{
+	uint64_t const lifting_key{key(BG, Z_c, t, rnd, seed)};
+	std::filesystem::path const file_path{path(lifting_key)};
+	if (std::filesystem::exists(file_path)) {
+		try {
+			MappedMatrixFile file{file_path.string()};
+			if (file.key() == lifting_key && file.rows() == BG.rows() * Z_c && file.cols() == BG.cols() * Z_c) {
+				return file.to_eigen();
+			}
+		}
+		catch (std::runtime_error const&) {
+			// Damaged file, lifted again and replaced below
+		}
+	}
+
+	std::seed_seq seed_sequence{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+	std::mt19937 engine{seed_sequence};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(BG, Z_c, t, rnd, engine).to_sparse()};
+
+	std::filesystem::path temp_path{file_path};
+	temp_path += ".tmp" + std::to_string(std::random_device{}()); // Unique among concurrent writers
+	save_matrix_binary(BinarySparseMatrix{H}, temp_path.string(), lifting_key);
+	std::filesystem::rename(temp_path, file_path);
+	return H;
+}
@@ -0,0 +1,31 @@
+#ifndef LIFTED_MATRIX_CACHE_H
+#define LIFTED_MATRIX_CACHE_H
+
+#include "ldpc-utils.hpp"
+
+#include <Eigen/Sparse>
+#include <cstdint>
+#include <filesystem>
+
+
+// Directory of lifted parity-check matrices in the binary matrix format, one file per lifting named by its key:
+// a hash of the base graph, Z_c, the base graph type and the shift mode, plus the seed when shifts are random.
+// A missing file is lifted with make_qc_matrix and stored; files are written under a temporary name and renamed,
+// so concurrent runs sharing the directory see either a whole file or none.
+class LiftedMatrixCache
+{
+public:
+	explicit LiftedMatrixCache(std::filesystem::path directory);
+	std::filesystem::path const& directory() const { return m_directory; }
+	std::filesystem::path path(uint64_t key) const;
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> lift(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& BG, size_t Z_c, BG_type t,
+		shift_randomness rnd = shift_randomness::NO_RANDOM, uint64_t seed = 0) const;
+
+	static uint64_t key(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& BG, size_t Z_c, BG_type t, shift_randomness rnd, uint64_t seed);
+
+private:
+	std::filesystem::path m_directory;
+};
+
+
+#endif
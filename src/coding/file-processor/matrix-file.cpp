@@ -0,0 +1,205 @@
+#include "matrix-file.h"
+#include "alist_matrix.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MATRIX_FILE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+static_assert(std::endian::native == std::endian::little, "Matrix files are little-endian");
+static_assert(sizeof(MatrixFileHeader) == 48 && sizeof(MatrixFileHeader) % sizeof(uint32_t) == 0);
+
+
+namespace
+{
+
+size_t arrays_size(size_t rows, size_t cols, size_t non_zeros)
+{
+	return (rows + 1 + cols + 1 + 2 * non_zeros) * sizeof(uint32_t);
+}
+
+}
+
+
+MappedMatrixFile::MappedMatrixFile(std::string const& filename)
+{
+#ifdef MATRIX_FILE_MMAP
+	int fd{::open(filename.c_str(), O_RDONLY)};
+	if (fd < 0) {
+		throw std::runtime_error{"Can't open matrix file " + filename};
+	}
+	struct stat file_stat;
+	if (::fstat(fd, &file_stat) != 0) {
+		::close(fd);
+		throw std::runtime_error{"Can't read matrix file " + filename};
+	}
+	m_size = static_cast<size_t>(file_stat.st_size);
+	if (m_size >= sizeof(MatrixFileHeader)) {
+		void * data{::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0)};
+		m_data = data == MAP_FAILED ? nullptr : data;
+	}
+	::close(fd);
+	if (m_size >= sizeof(MatrixFileHeader) && !m_data) {
+		throw std::runtime_error{"Can't map matrix file " + filename};
+	}
+#else
+	std::ifstream file{filename, std::ios::binary | std::ios::ate};
+	if (!file) {
+		throw std::runtime_error{"Can't open matrix file " + filename};
+	}
+	m_size = static_cast<size_t>(file.tellg());
+	m_buffer.resize((m_size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+	file.seekg(0);
+	if (!file.read(reinterpret_cast<char *>(m_buffer.data()), m_size)) {
+		throw std::runtime_error{"Can't read matrix file " + filename};
+	}
+	m_data = m_buffer.data();
+#endif
+
+	try {
+		check(filename);
+	}
+	catch (...) {
+		unmap(); // Destructor does not run for a throwing constructor
+		throw;
+	}
+}
+
+
+void MappedMatrixFile::check(std::string const& filename)
+{
+	if (m_size < sizeof(MatrixFileHeader)) {
+		throw std::runtime_error{"Matrix file " + filename + " is truncated"};
+	}
+	m_header = static_cast<MatrixFileHeader const*>(m_data);
+	if (std::memcmp(m_header->magic, MATRIX_FILE_MAGIC, sizeof(MATRIX_FILE_MAGIC)) != 0) {
+		throw std::runtime_error{"Not a matrix file: " + filename};
+	}
+	if (m_header->version != MATRIX_FILE_VERSION) {
+		throw std::runtime_error{"Unsupported matrix file version in " + filename};
+	}
+	uint64_t constexpr MAX_INDEX{std::numeric_limits<uint32_t>::max()};
+	if (rows() > MAX_INDEX || cols() > MAX_INDEX || non_zeros() > MAX_INDEX
+		|| m_size != sizeof(MatrixFileHeader) + arrays_size(rows(), cols(), non_zeros())) {
+		throw std::runtime_error{"Matrix file " + filename + " has wrong size"};
+	}
+	m_arrays = reinterpret_cast<uint32_t const*>(static_cast<char const*>(m_data) + sizeof(MatrixFileHeader));
+	if (!BinarySparseMatrix::is_valid(rows(), cols(), row_ptr(), col_indices(), col_ptr(), row_indices())) {
+		throw std::runtime_error{"Matrix file " + filename + " is malformed"};
+	}
+}
+
+
+MappedMatrixFile::~MappedMatrixFile()
+{
+	unmap();
+}
+
+
+void MappedMatrixFile::unmap()
+{
+#ifdef MATRIX_FILE_MMAP
+	if (m_data) {
+		::munmap(const_cast<void *>(m_data), m_size);
+		m_data = nullptr;
+	}
+#endif
+}
+
+
+BinarySparseMatrix MappedMatrixFile::to_binary_sparse() const
+{
+	return {rows(), cols(), row_ptr(), col_indices(), col_ptr(), row_indices()};
+}
+
+
+Eigen::SparseMatrix<GF2, Eigen::RowMajor> MappedMatrixFile::to_eigen() const
+{
+	// Eigen keeps the uint32 offsets and indices as int
+	uint64_t constexpr MAX_INDEX{std::numeric_limits<Eigen::SparseMatrix<GF2, Eigen::RowMajor>::StorageIndex>::max()};
+	if (rows() > MAX_INDEX || cols() > MAX_INDEX || non_zeros() > MAX_INDEX) {
+		throw std::runtime_error{"Matrix file is too large for Eigen::SparseMatrix"};
+	}
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H(rows(), cols());
+	H.resizeNonZeros(non_zeros());
+	std::copy(row_ptr().begin(), row_ptr().end(), H.outerIndexPtr());
+	std::copy(col_indices().begin(), col_indices().end(), H.innerIndexPtr());
+	std::fill(H.valuePtr(), H.valuePtr() + non_zeros(), GF2{1});
+	return H;
+}
+
+
+void save_matrix_binary(BinarySparseMatrix const& H, std::string const& filename, uint64_t key)
+{
+	MatrixFileHeader header{};
+	std::memcpy(header.magic, MATRIX_FILE_MAGIC, sizeof(MATRIX_FILE_MAGIC));
+	header.version = MATRIX_FILE_VERSION;
+	header.rows = H.rows();
+	header.cols = H.cols();
+	header.non_zeros = H.non_zeros();
+	header.key = key;
+
+	std::ofstream file{filename, std::ios::binary | std::ios::trunc};
+	if (!file) {
+		throw std::runtime_error{"Can't create matrix file " + filename};
+	}
+	file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+	for (std::vector<uint32_t> const* array : {&H.row_ptr(), &H.col_indices(), &H.col_ptr(), &H.row_indices()}) {
+		file.write(reinterpret_cast<char const*>(array->data()), array->size() * sizeof(uint32_t));
+	}
+	if (!file.flush()) {
+		throw std::runtime_error{"Can't write matrix file " + filename};
+	}
+}
+
+
+void save_matrix_binary(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, std::string const& filename)
+{
+	save_matrix_binary(BinarySparseMatrix{H}, filename);
+}
+
+
+Eigen::SparseMatrix<GF2, Eigen::RowMajor> load_matrix_binary(std::string const& filename)
+{
+	return MappedMatrixFile{filename}.to_eigen();
+}
+
+
+bool is_matrix_binary_file(std::string const& filename)
+{
+	char magic[sizeof(MATRIX_FILE_MAGIC)]{};
+	std::ifstream file{filename, std::ios::binary};
+	return file.read(magic, sizeof(magic)) && std::memcmp(magic, MATRIX_FILE_MAGIC, sizeof(magic)) == 0;
+}
+
+
+Eigen::SparseMatrix<GF2, Eigen::RowMajor> load_matrix(std::string const& filename)
+{
+	if (is_matrix_binary_file(filename)) {
+		return load_matrix_binary(filename);
+	}
+	return read_alist_sparse(filename);
+}
+
+
+void alist_to_binary(std::string const& alist_filename, std::string const& binary_filename)
+{
+	save_matrix_binary(read_alist_sparse(alist_filename), binary_filename);
+}
+
+
+void binary_to_alist(std::string const& binary_filename, std::string const& alist_filename)
+{
+	write_alist_sparse(load_matrix_binary(binary_filename), alist_filename);
+}
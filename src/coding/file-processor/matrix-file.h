@@ -0,0 +1,78 @@
+#ifndef MATRIX_FILE_H
+#define MATRIX_FILE_H
+
+#include "binary-sparse-matrix.hpp"
+
+#include <Eigen/Sparse>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+
+// Binary parity-check matrix file (.ldpcm): a MatrixFileHeader followed by the uint32 arrays
+// row_ptr (rows + 1), col_indices (non_zeros), col_ptr (cols + 1) and row_indices (non_zeros) of a BinarySparseMatrix,
+// in native little-endian order. A mapped file is used in place, nothing is parsed.
+inline constexpr char MATRIX_FILE_MAGIC[8]{'L', 'D', 'P', 'C', 'C', 'S', 'R', '\0'};
+inline constexpr uint32_t MATRIX_FILE_VERSION{1};
+
+struct MatrixFileHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t reserved;
+	uint64_t rows;
+	uint64_t cols;
+	uint64_t non_zeros;
+	uint64_t key; // Cache key of a lifted matrix (see LiftedMatrixCache), 0 otherwise
+};
+
+
+// Read-only view of a matrix file: mmap where POSIX is available, the file read into memory elsewhere;
+// opening checks the arrays in full, so a damaged file is rejected instead of reaching the decoders
+class MappedMatrixFile
+{
+public:
+	explicit MappedMatrixFile(std::string const& filename);
+	MappedMatrixFile(MappedMatrixFile const&) = delete;
+	MappedMatrixFile & operator=(MappedMatrixFile const&) = delete;
+	~MappedMatrixFile();
+
+	size_t rows() const { return m_header->rows; }
+	size_t cols() const { return m_header->cols; }
+	size_t non_zeros() const { return m_header->non_zeros; }
+	uint64_t key() const { return m_header->key; }
+	std::span<uint32_t const> row_ptr() const { return {m_arrays, rows() + 1}; }
+	std::span<uint32_t const> col_indices() const { return {m_arrays + rows() + 1, non_zeros()}; }
+	std::span<uint32_t const> col_ptr() const { return {m_arrays + rows() + 1 + non_zeros(), cols() + 1}; }
+	std::span<uint32_t const> row_indices() const { return {m_arrays + rows() + cols() + 2 + non_zeros(), non_zeros()}; }
+	BinarySparseMatrix to_binary_sparse() const;
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> to_eigen() const; // Throws for sizes past the int indices of Eigen
+
+private:
+	void check(std::string const& filename); // Header, size and arrays of the loaded file
+	void unmap();
+
+	void const* m_data{nullptr};
+	size_t m_size{0};
+	std::vector<uint64_t> m_buffer; // File contents when it is not mapped
+	MatrixFileHeader const* m_header{nullptr};
+	uint32_t const* m_arrays{nullptr};
+};
+
+
+void save_matrix_binary(BinarySparseMatrix const& H, std::string const& filename, uint64_t key = 0);
+void save_matrix_binary(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, std::string const& filename);
+Eigen::SparseMatrix<GF2, Eigen::RowMajor> load_matrix_binary(std::string const& filename);
+
+// Whether filename starts with MATRIX_FILE_MAGIC
+bool is_matrix_binary_file(std::string const& filename);
+
+// Binary or .alist file, told apart by the magic
+Eigen::SparseMatrix<GF2, Eigen::RowMajor> load_matrix(std::string const& filename);
+
+void alist_to_binary(std::string const& alist_filename, std::string const& binary_filename);
+void binary_to_alist(std::string const& binary_filename, std::string const& alist_filename);
+
+
+#endif
@@ -0,0 +1,265 @@
+#ifndef BINARY_SPARSE_MATRIX_H
+#define BINARY_SPARSE_MATRIX_H
+
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "GF2.hpp"
+
+
+// Sparse matrix over GF(2) that stores only positions of ones, in both orientations:
+// CSR (ones of row j are col_indices()[row_ptr()[j] .. row_ptr()[j + 1])) and
+// CSC (ones of column i are row_indices()[col_ptr()[i] .. col_ptr()[i + 1])), indices ascending.
+// Products work on bits directly instead of GF2 arithmetic; packed vectors hold bit k in word k / 64, bit k % 64.
+class BinarySparseMatrix
+{
+public:
+	BinarySparseMatrix() = default;
+
+	// Entries are (row, col) positions of ones; a position given twice cancels out as in GF(2) addition
+	BinarySparseMatrix(size_t rows, size_t cols, std::vector<std::pair<uint32_t, uint32_t>> entries) :
+		m_rows{rows}, m_cols{cols}
+	{
+		if (rows > std::numeric_limits<uint32_t>::max() || cols > std::numeric_limits<uint32_t>::max()) {
+			throw std::runtime_error{"BinarySparseMatrix: dimensions exceed 32-bit indices"};
+		}
+		std::sort(entries.begin(), entries.end());
+		m_row_ptr.assign(rows + 1, 0);
+		for (size_t k{0}; k < entries.size(); ) {
+			auto [row, col] = entries[k];
+			if (row >= rows || col >= cols) {
+				throw std::out_of_range{"BinarySparseMatrix: entry out of range"};
+			}
+			size_t count{0};
+			for (; k < entries.size() && entries[k] == std::make_pair(row, col); ++k) {
+				++count;
+			}
+			if (count % 2) {
+				m_col_indices.push_back(col);
+				++m_row_ptr[row + 1];
+			}
+		}
+		for (size_t j{0}; j < rows; ++j) {
+			m_row_ptr[j + 1] += m_row_ptr[j];
+		}
+		build_csc();
+	}
+
+	// Both orientations given directly, e.g. by a mapped matrix file. Their structure is checked but not
+	// that they describe the same matrix, which is up to the caller.
+	BinarySparseMatrix(size_t rows, size_t cols, std::span<uint32_t const> row_ptr, std::span<uint32_t const> col_indices,
+		std::span<uint32_t const> col_ptr, std::span<uint32_t const> row_indices) :
+		m_rows{rows}, m_cols{cols}, m_row_ptr(row_ptr.begin(), row_ptr.end()), m_col_indices(col_indices.begin(), col_indices.end()),
+		m_col_ptr(col_ptr.begin(), col_ptr.end()), m_row_indices(row_indices.begin(), row_indices.end())
+	{
+		if (rows > std::numeric_limits<uint32_t>::max() || cols > std::numeric_limits<uint32_t>::max()) {
+			throw std::runtime_error{"BinarySparseMatrix: dimensions exceed 32-bit indices"};
+		}
+		if (!is_valid(rows, cols, m_row_ptr, m_col_indices, m_col_ptr, m_row_indices)) {
+			throw std::runtime_error{"BinarySparseMatrix: malformed compressed arrays"};
+		}
+	}
+
+	// Explicitly stored zeros of H are dropped
+	explicit BinarySparseMatrix(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H) :
+		m_rows{static_cast<size_t>(H.rows())}, m_cols{static_cast<size_t>(H.cols())}
+	{
+		if (m_rows > std::numeric_limits<uint32_t>::max() || m_cols > std::numeric_limits<uint32_t>::max()
+			|| static_cast<size_t>(H.nonZeros()) > std::numeric_limits<uint32_t>::max()) {
+			throw std::runtime_error{"BinarySparseMatrix: matrix exceeds 32-bit indices"};
+		}
+		m_row_ptr.resize(m_rows + 1);
+		m_row_ptr[0] = 0;
+		m_col_indices.reserve(H.nonZeros());
+		for (Eigen::Index j{0}; j < H.outerSize(); ++j) {
+			for (Eigen::SparseMatrix<GF2, Eigen::RowMajor>::InnerIterator it(H, j); it; ++it) {
+				if (static_cast<bool>(it.value())) {
+					m_col_indices.push_back(static_cast<uint32_t>(it.col()));
+				}
+			}
+			m_row_ptr[j + 1] = static_cast<uint32_t>(m_col_indices.size());
+		}
+		build_csc();
+	}
+
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> to_eigen() const
+	{
+		std::vector<Eigen::Triplet<GF2>> triplets;
+		triplets.reserve(non_zeros());
+		for (size_t j{0}; j < m_rows; ++j) {
+			for (uint32_t col : row(j)) {
+				triplets.emplace_back(j, col, GF2{1});
+			}
+		}
+		Eigen::SparseMatrix<GF2, Eigen::RowMajor> H(m_rows, m_cols);
+		H.setFromTriplets(triplets.begin(), triplets.end());
+		return H;
+	}
+
+	size_t rows() const { return m_rows; }
+	size_t cols() const { return m_cols; }
+	size_t non_zeros() const { return m_col_indices.size(); }
+	std::vector<uint32_t> const& row_ptr() const { return m_row_ptr; }
+	std::vector<uint32_t> const& col_indices() const { return m_col_indices; }
+	std::vector<uint32_t> const& col_ptr() const { return m_col_ptr; }
+	std::vector<uint32_t> const& row_indices() const { return m_row_indices; }
+	std::span<uint32_t const> row(size_t j) const { return {m_col_indices.data() + m_row_ptr[j], m_row_ptr[j + 1] - m_row_ptr[j]}; }
+	std::span<uint32_t const> col(size_t i) const { return {m_row_indices.data() + m_col_ptr[i], m_col_ptr[i + 1] - m_col_ptr[i]}; }
+
+	bool coeff(size_t j, size_t i) const
+	{
+		std::span<uint32_t const> ones{row(j)};
+		return std::binary_search(ones.begin(), ones.end(), static_cast<uint32_t>(i));
+	}
+
+	// Transposition swaps the two orientations, no sorting needed
+	BinarySparseMatrix transpose() const
+	{
+		BinarySparseMatrix T;
+		T.m_rows = m_cols;
+		T.m_cols = m_rows;
+		T.m_row_ptr = m_col_ptr;
+		T.m_col_indices = m_row_indices;
+		T.m_col_ptr = m_row_ptr;
+		T.m_row_indices = m_col_indices;
+		return T;
+	}
+
+	BinarySparseMatrix block(size_t row_begin, size_t col_begin, size_t rows, size_t cols) const
+	{
+		if (row_begin + rows > m_rows || col_begin + cols > m_cols) {
+			throw std::out_of_range{"BinarySparseMatrix: block out of range"};
+		}
+		BinarySparseMatrix B;
+		B.m_rows = rows;
+		B.m_cols = cols;
+		B.m_row_ptr.resize(rows + 1);
+		B.m_row_ptr[0] = 0;
+		for (size_t j{0}; j < rows; ++j) {
+			std::span<uint32_t const> ones{row(row_begin + j)};
+			auto first{std::lower_bound(ones.begin(), ones.end(), static_cast<uint32_t>(col_begin))};
+			auto last{std::lower_bound(first, ones.end(), static_cast<uint32_t>(col_begin + cols))};
+			for (; first != last; ++first) {
+				B.m_col_indices.push_back(*first - static_cast<uint32_t>(col_begin));
+			}
+			B.m_row_ptr[j + 1] = static_cast<uint32_t>(B.m_col_indices.size());
+		}
+		B.build_csc();
+		return B;
+	}
+
+	// y = H * x over packed vectors: x holds cols() bits, y receives rows() bits (bits past rows() are cleared)
+	void multiply(std::span<uint64_t const> x, std::span<uint64_t> y) const
+	{
+		if (x.size() != packed_size(m_cols) || y.size() != packed_size(m_rows)) {
+			throw std::runtime_error{"BinarySparseMatrix: packed vector size incompatible"};
+		}
+		std::fill(y.begin(), y.end(), 0);
+		for (size_t j{0}; j < m_rows; ++j) {
+			uint64_t parity{0};
+			for (uint32_t i : row(j)) {
+				parity ^= x[i >> 6] >> (i & 63);
+			}
+			y[j >> 6] |= (parity & 1) << (j & 63);
+		}
+	}
+
+	Eigen::VectorX<GF2> operator*(Eigen::VectorX<GF2> const& x) const
+	{
+		if (static_cast<size_t>(x.size()) != m_cols) {
+			throw std::runtime_error{"BinarySparseMatrix: vector size incompatible"};
+		}
+		Eigen::VectorX<GF2> y(m_rows);
+		for (size_t j{0}; j < m_rows; ++j) {
+			bool parity{false};
+			for (uint32_t i : row(j)) {
+				parity ^= static_cast<bool>(x[i]);
+			}
+			y[j] = parity;
+		}
+		return y;
+	}
+
+	bool operator==(BinarySparseMatrix const& other) const
+	{
+		return m_rows == other.m_rows && m_cols == other.m_cols && m_row_ptr == other.m_row_ptr && m_col_indices == other.m_col_indices;
+	}
+
+	static size_t packed_size(size_t bits) { return (bits + 63) / 64; }
+
+	// Whether CSR and CSC arrays describe the same rows x cols matrix
+	static bool is_valid(size_t rows, size_t cols, std::span<uint32_t const> row_ptr, std::span<uint32_t const> col_indices,
+		std::span<uint32_t const> col_ptr, std::span<uint32_t const> row_indices)
+	{
+		if (!is_compressed(row_ptr, col_indices, rows, cols) || !is_compressed(col_ptr, row_indices, cols, rows)
+			|| col_indices.size() != row_indices.size()) {
+			return false;
+		}
+		// Walking CSR rows in order meets the entries of every column in its CSC order
+		std::vector<uint32_t> next{col_ptr.begin(), col_ptr.end() - 1};
+		for (uint32_t j{0}; j < rows; ++j) {
+			for (uint32_t k{row_ptr[j]}; k < row_ptr[j + 1]; ++k) {
+				uint32_t col{col_indices[k]};
+				if (next[col] == col_ptr[col + 1] || row_indices[next[col]++] != j) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+private:
+	// ptr has lines + 1 non-decreasing offsets from 0 to indices.size(), indices of every line ascend below bound
+	static bool is_compressed(std::span<uint32_t const> ptr, std::span<uint32_t const> indices, size_t lines, size_t bound)
+	{
+		if (ptr.size() != lines + 1 || ptr.front() != 0 || ptr.back() != indices.size()) {
+			return false;
+		}
+		for (size_t j{0}; j < lines; ++j) {
+			if (ptr[j] > ptr[j + 1]) {
+				return false;
+			}
+			for (uint32_t k{ptr[j]}; k < ptr[j + 1]; ++k) {
+				if (indices[k] >= bound || (k > ptr[j] && indices[k] <= indices[k - 1])) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	// Counting sort of CSR entries by column keeps rows ascending within every column
+	void build_csc()
+	{
+		m_col_ptr.assign(m_cols + 1, 0);
+		for (uint32_t col : m_col_indices) {
+			++m_col_ptr[col + 1];
+		}
+		for (size_t i{0}; i < m_cols; ++i) {
+			m_col_ptr[i + 1] += m_col_ptr[i];
+		}
+		m_row_indices.resize(m_col_indices.size());
+		std::vector<uint32_t> fill{m_col_ptr.begin(), m_col_ptr.end() - 1};
+		for (size_t j{0}; j < m_rows; ++j) {
+			for (uint32_t col : row(j)) {
+				m_row_indices[fill[col]++] = static_cast<uint32_t>(j);
+			}
+		}
+	}
+
+	size_t m_rows{0};
+	size_t m_cols{0};
+	std::vector<uint32_t> m_row_ptr{0};
+	std::vector<uint32_t> m_col_indices;
+	std::vector<uint32_t> m_col_ptr{0};
+	std::vector<uint32_t> m_row_indices;
+};
+
+
+#endif
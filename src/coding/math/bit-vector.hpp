@@ -0,0 +1,131 @@
+#ifndef BIT_VECTOR_H
+#define BIT_VECTOR_H
+
+#include <Eigen/Core>
+#include <bit>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include "GF2.hpp"
+#include "binary-sparse-matrix.hpp"
+
+
+// Vector over GF(2) packed 64 bits per word: bit i is bit i % 64 of word i / 64.
+// Bits of the last word past size() are always zero, so comparison and popcount work on whole words.
+class BitVector
+{
+public:
+	BitVector() = default;
+	explicit BitVector(size_t size) : m_size{size}, m_words(BinarySparseMatrix::packed_size(size), 0) {}
+
+	explicit BitVector(Eigen::VectorX<GF2> const& v) : BitVector(static_cast<size_t>(v.size()))
+	{
+		for (size_t i{0}; i < m_size; ++i) {
+			m_words[i >> 6] |= uint64_t{static_cast<bool>(v[i])} << (i & 63);
+		}
+	}
+
+	Eigen::VectorX<GF2> to_eigen() const
+	{
+		Eigen::VectorX<GF2> v(m_size);
+		for (size_t i{0}; i < m_size; ++i) {
+			v[i] = get(i);
+		}
+		return v;
+	}
+
+	size_t size() const { return m_size; }
+	std::span<uint64_t> words() { return m_words; }
+	std::span<uint64_t const> words() const { return m_words; }
+
+	bool get(size_t i) const { return (m_words[i >> 6] >> (i & 63)) & 1; }
+	void flip(size_t i) { m_words[i >> 6] ^= uint64_t{1} << (i & 63); }
+	void set(size_t i, bool bit)
+	{
+		uint64_t mask{uint64_t{1} << (i & 63)};
+		m_words[i >> 6] = bit ? (m_words[i >> 6] | mask) : (m_words[i >> 6] & ~mask);
+	}
+	void clear() { std::fill(m_words.begin(), m_words.end(), 0); }
+
+	// Uniformly random bits, one engine call per word for 64-bit engines
+	template <typename URBG>
+	void randomize(URBG & gen)
+	{
+		std::uniform_int_distribution<uint64_t> word_distribution;
+		for (uint64_t & word : m_words) {
+			word = word_distribution(gen);
+		}
+		clear_tail();
+	}
+
+	size_t count() const
+	{
+		size_t ones{0};
+		for (uint64_t word : m_words) {
+			ones += std::popcount(word);
+		}
+		return ones;
+	}
+
+	BitVector & operator^=(BitVector const& other)
+	{
+		check_size(other);
+		for (size_t k{0}; k < m_words.size(); ++k) {
+			m_words[k] ^= other.m_words[k];
+		}
+		return *this;
+	}
+
+	friend BitVector operator^(BitVector lhs, BitVector const& rhs)
+	{
+		lhs ^= rhs;
+		return lhs;
+	}
+
+	friend size_t hamming_distance(BitVector const& a, BitVector const& b)
+	{
+		a.check_size(b);
+		size_t distance{0};
+		for (size_t k{0}; k < a.m_words.size(); ++k) {
+			distance += std::popcount(a.m_words[k] ^ b.m_words[k]);
+		}
+		return distance;
+	}
+
+	bool operator==(BitVector const& other) const { return m_size == other.m_size && m_words == other.m_words; }
+
+private:
+	void check_size(BitVector const& other) const
+	{
+		if (m_size != other.m_size) {
+			throw std::runtime_error{"BitVector: sizes differ"};
+		}
+	}
+
+	void clear_tail()
+	{
+		if (m_size & 63) {
+			m_words.back() &= (uint64_t{1} << (m_size & 63)) - 1;
+		}
+	}
+
+	size_t m_size{0};
+	std::vector<uint64_t> m_words;
+};
+
+
+// H * x with word-level reads of x
+inline BitVector syndrome(BinarySparseMatrix const& H, BitVector const& x)
+{
+	if (x.size() != H.cols()) {
+		throw std::runtime_error{"BitVector: size incompatible with matrix"};
+	}
+	BitVector s(H.rows());
+	H.multiply(x.words(), s.words());
+	return s;
+}
+
+
+#endif
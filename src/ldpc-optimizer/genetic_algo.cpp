@@ -94,9 +94,7 @@ std::multimap<Result, GeneticMatrix, std::greater<Result>> calculate_obj_func(
 
         taskflow.emplace([&](){
 
-            GeneticMatrix expanded_mat = {enhance_from_base(gen_matrix.matrix, Z), gen_matrix.history, gen_matrix.matrix_id};
-            expanded_mat = {shift_eyes(expanded_mat.matrix, Z, bg_type, shift_randomness::COMBINE), gen_matrix.history, gen_matrix.matrix_id};
-            expanded_mat.matrix.makeCompressed();
+            GeneticMatrix expanded_mat = {make_qc_matrix(gen_matrix.matrix, Z, bg_type, shift_randomness::COMBINE).to_sparse(), gen_matrix.history, gen_matrix.matrix_id};
 
             benchmarks::BSChannellWynersEC busc_bm{expanded_mat.matrix};
 
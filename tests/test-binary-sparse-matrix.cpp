@@ -0,0 +1,104 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "binary-sparse-matrix.hpp"
+
+#include <doctest/doctest.h>
+#include <Eigen/Sparse>
+#include <random>
+
+
+Eigen::SparseMatrix<GF2, Eigen::RowMajor> random_sparse(size_t rows, size_t cols, double density, std::mt19937 & gen)
+{
+	std::bernoulli_distribution one_distribution{density};
+	std::vector<Eigen::Triplet<GF2>> triplets;
+	for (size_t j{0}; j < rows; ++j) {
+		for (size_t i{0}; i < cols; ++i) {
+			if (one_distribution(gen)) {
+				triplets.emplace_back(j, i, GF2{1});
+			}
+		}
+	}
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H(rows, cols);
+	H.setFromTriplets(triplets.begin(), triplets.end());
+	return H;
+}
+
+
+Eigen::VectorX<GF2> random_vector(size_t size, std::mt19937 & gen)
+{
+	std::bernoulli_distribution bit_distribution{0.5};
+	Eigen::VectorX<GF2> x(size);
+	for (GF2 & bit : x) {
+		bit = bit_distribution(gen);
+	}
+	return x;
+}
+
+
+TEST_CASE("BinarySparseMatrix round-trips through Eigen and keeps both orientations consistent") {
+	std::mt19937 gen{1};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{random_sparse(70, 130, 0.05, gen)};
+	BinarySparseMatrix B{H};
+
+	CHECK( B.rows() == 70 );
+	CHECK( B.cols() == 130 );
+	CHECK( B.non_zeros() == static_cast<size_t>(H.nonZeros()) );
+	CHECK( B.to_eigen().toDense() == H.toDense() );
+	for (size_t i{0}; i < B.cols(); ++i) {
+		for (uint32_t j : B.col(i)) {
+			CHECK( B.coeff(j, i) );
+		}
+	}
+	CHECK( B.col_ptr().back() == B.non_zeros() );
+	CHECK( B.transpose().transpose() == B );
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H_transposed{H.transpose()};
+	CHECK( B.transpose().to_eigen().toDense() == H_transposed.toDense() );
+}
+
+TEST_CASE("BinarySparseMatrix drops stored zeros and cancels repeated entries") {
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H(2, 3);
+	H.insert(0, 1) = GF2{1};
+	H.insert(1, 2) = GF2{0};
+	CHECK( BinarySparseMatrix{H}.non_zeros() == 1 );
+
+	BinarySparseMatrix B{2, 3, {{0, 1}, {1, 2}, {1, 2}, {1, 0}, {1, 0}, {1, 0}}};
+	CHECK( B.non_zeros() == 2 );
+	CHECK( B.coeff(0, 1) );
+	CHECK( B.coeff(1, 0) );
+	CHECK( !B.coeff(1, 2) );
+	CHECK_THROWS_AS( BinarySparseMatrix(2, 3, {{2, 0}}), std::out_of_range );
+}
+
+TEST_CASE("BinarySparseMatrix products agree with Eigen") {
+	std::mt19937 gen{2};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{random_sparse(100, 150, 0.04, gen)};
+	BinarySparseMatrix B{H};
+
+	for (size_t trial{0}; trial < 10; ++trial) {
+		Eigen::VectorX<GF2> x{random_vector(B.cols(), gen)};
+		Eigen::VectorX<GF2> y{H * x};
+		CHECK( B * x == y );
+
+		std::vector<uint64_t> x_packed(BinarySparseMatrix::packed_size(B.cols()), 0);
+		for (size_t i{0}; i < B.cols(); ++i) {
+			x_packed[i / 64] |= uint64_t{static_cast<bool>(x[i])} << (i % 64);
+		}
+		std::vector<uint64_t> y_packed(BinarySparseMatrix::packed_size(B.rows()));
+		B.multiply(x_packed, y_packed);
+		for (size_t j{0}; j < B.rows(); ++j) {
+			CHECK( static_cast<bool>((y_packed[j / 64] >> (j % 64)) & 1) == static_cast<bool>(y[j]) );
+		}
+	}
+	CHECK_THROWS( B * Eigen::VectorX<GF2>(B.rows()) );
+}
+
+TEST_CASE("BinarySparseMatrix block matches Eigen block") {
+	std::mt19937 gen{3};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{random_sparse(40, 60, 0.1, gen)};
+	BinarySparseMatrix B{H};
+
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H_block{H.block(5, 7, 20, 30)};
+	CHECK( B.block(5, 7, 20, 30) == BinarySparseMatrix{H_block} );
+	CHECK( B.block(0, 0, 40, 60) == B );
+	CHECK_THROWS_AS( B.block(30, 0, 20, 10), std::out_of_range );
+}
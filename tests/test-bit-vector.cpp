@@ -0,0 +1,89 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "bit-vector.hpp"
+
+#include <doctest/doctest.h>
+#include <Eigen/Sparse>
+#include <random>
+
+
+Eigen::VectorX<GF2> random_vector(size_t size, std::mt19937 & gen)
+{
+	std::bernoulli_distribution bit_distribution{0.5};
+	Eigen::VectorX<GF2> x(size);
+	for (GF2 & bit : x) {
+		bit = bit_distribution(gen);
+	}
+	return x;
+}
+
+
+TEST_CASE("BitVector round-trips through Eigen and supports bit access") {
+	std::mt19937 gen{1};
+	Eigen::VectorX<GF2> v{random_vector(150, gen)};
+	BitVector b{v};
+
+	CHECK( b.size() == 150 );
+	CHECK( b.words().size() == 3 );
+	CHECK( b.to_eigen() == v );
+	for (size_t i{0}; i < b.size(); ++i) {
+		CHECK( b.get(i) == static_cast<bool>(v[i]) );
+	}
+
+	b.flip(7);
+	CHECK( b.get(7) != static_cast<bool>(v[7]) );
+	b.set(7, static_cast<bool>(v[7]));
+	CHECK( b == BitVector{v} );
+}
+
+TEST_CASE("BitVector XOR and Hamming distance agree with element-wise counting") {
+	std::mt19937 gen{2};
+	for (size_t size : {1, 63, 64, 65, 200}) {
+		Eigen::VectorX<GF2> u{random_vector(size, gen)};
+		Eigen::VectorX<GF2> v{random_vector(size, gen)};
+		size_t expected_distance{0};
+		for (size_t i{0}; i < size; ++i) {
+			expected_distance += u[i] != v[i];
+		}
+		CHECK( hamming_distance(BitVector{u}, BitVector{v}) == expected_distance );
+		CHECK( (BitVector{u} ^ BitVector{v}).count() == expected_distance );
+		CHECK( (BitVector{u} ^ BitVector{u}).count() == 0 );
+	}
+	CHECK_THROWS( BitVector(3) ^ BitVector(4) );
+}
+
+TEST_CASE("BitVector random fill keeps bits past the size cleared") {
+	std::mt19937_64 gen{3};
+	BitVector b(100);
+	size_t ones{0};
+	for (size_t trial{0}; trial < 100; ++trial) {
+		b.randomize(gen);
+		CHECK( (b.words().back() >> 36) == 0 );
+		ones += b.count();
+	}
+	CHECK( ones > 4500 );
+	CHECK( ones < 5500 );
+}
+
+TEST_CASE("BitVector syndrome matches the Eigen product") {
+	std::mt19937 gen{4};
+	std::bernoulli_distribution one_distribution{0.05};
+	std::vector<Eigen::Triplet<GF2>> triplets;
+	for (size_t j{0}; j < 90; ++j) {
+		for (size_t i{0}; i < 140; ++i) {
+			if (one_distribution(gen)) {
+				triplets.emplace_back(j, i, GF2{1});
+			}
+		}
+	}
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H(90, 140);
+	H.setFromTriplets(triplets.begin(), triplets.end());
+	BinarySparseMatrix B{H};
+
+	for (size_t trial{0}; trial < 10; ++trial) {
+		Eigen::VectorX<GF2> x{random_vector(H.cols(), gen)};
+		Eigen::VectorX<GF2> expected{H * x};
+		CHECK( syndrome(B, BitVector{x}) == BitVector{expected} );
+	}
+	CHECK_THROWS( syndrome(B, BitVector(H.rows())) );
+}
@@ -0,0 +1,184 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "decoders.h"
+#include "ldpc-utils.hpp"
+
+#include <doctest/doctest.h>
+#include <Eigen/Sparse>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+
+// Every allocation of this executable is counted: the C allocation functions are interposed and forward to glibc's own
+// implementations, which also catches Eigen's aligned_malloc and direct malloc calls, and global operator new is replaced
+// in case the C++ runtime does not allocate through malloc. Sanitizers interpose malloc themselves, so there only
+// operator new is counted.
+static std::atomic<size_t> allocations_count{0};
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define COUNT_C_ALLOCATIONS
+extern "C"
+{
+void * __libc_malloc(std::size_t size);
+void * __libc_calloc(std::size_t number, std::size_t size);
+void * __libc_realloc(void * ptr, std::size_t size);
+void * __libc_memalign(std::size_t alignment, std::size_t size);
+void __libc_free(void * ptr);
+
+void * malloc(std::size_t size)
+{
+	++allocations_count;
+	return __libc_malloc(size);
+}
+
+void * calloc(std::size_t number, std::size_t size)
+{
+	++allocations_count;
+	return __libc_calloc(number, size);
+}
+
+void * realloc(void * ptr, std::size_t size)
+{
+	++allocations_count;
+	return __libc_realloc(ptr, size);
+}
+
+void * aligned_alloc(std::size_t alignment, std::size_t size)
+{
+	++allocations_count;
+	return __libc_memalign(alignment, size);
+}
+
+void * memalign(std::size_t alignment, std::size_t size)
+{
+	++allocations_count;
+	return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void ** ptr, std::size_t alignment, std::size_t size)
+{
+	++allocations_count;
+	if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0) {
+		return EINVAL;
+	}
+	*ptr = __libc_memalign(alignment, size);
+	return *ptr || size == 0 ? 0 : ENOMEM;
+}
+
+void free(void * ptr)
+{
+	__libc_free(ptr);
+}
+}
+#endif
+
+// The replacements pair malloc with free, which GCC can't see through
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void * operator new(std::size_t size)
+{
+	++allocations_count;
+	if (void * ptr{std::malloc(size ? size : 1)}) {
+		return ptr;
+	}
+	throw std::bad_alloc{};
+}
+
+void operator delete(void * ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+#pragma GCC diagnostic pop
+
+
+TEST_CASE("context decoders writing into caller buffers do not allocate") {
+	size_t constexpr Z{16};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> bg{vec_to_sparse_m({{1, 1, 1, 1, 0, 0, 1, 0, 0, 1, 1, 1, 0, 0},
+	                                                              {1, 0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 0},
+	                                                              {1, 1, 0, 1, 1, 0, 0, 0, 1, 0, 1, 0, 1, 1},
+	                                                              {0, 1, 1, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 1},})};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(bg, Z, BG_type::BG2).to_sparse()};
+	DecoderContext ctx{H, 1};
+
+	std::mt19937 gen{11};
+	std::bernoulli_distribution bit_distribution{0.5};
+	std::bernoulli_distribution error_distribution{0.03};
+	double const llr_base_val{log((1.0 - 0.03) / 0.03)};
+
+	std::vector<std::vector<LLR>> llrs(20);
+	std::vector<Eigen::VectorX<GF2>> syndromes(llrs.size());
+	for (size_t frame_number{0}; frame_number < llrs.size(); ++frame_number) {
+		Eigen::VectorX<GF2> word(H.cols());
+		for (GF2 & bit : word) {
+			bit = bit_distribution(gen);
+		}
+		syndromes[frame_number] = H * word;
+		for (GF2 bit : word) {
+			bool received{static_cast<bool>(bit) != error_distribution(gen)};
+			llrs[frame_number].push_back(received ? -llr_base_val : llr_base_val);
+		}
+	}
+	std::vector<GF2> out(H.cols());
+	DecoderParams float_params;
+	float_params.scale = 0.75;
+	float_params.layer_size = Z;
+	float_params.max_iters = 30;
+	float_params.precision = MessagePrecision::FLOAT;
+
+	// Warm-up sizes the edge buffers of the scratch
+	decode_to_syndrome_into(ctx, 0, LDPC_algo::NMS, llrs[0], syndromes[0], out, 0.75, Z, 30);
+	decode_to_syndrome_into(ctx, 0, LDPC_algo::SSP, llrs[0], syndromes[0], out, 0.75, Z, 30);
+	decode_to_syndrome_into(ctx, 0, LDPC_algo::SNMS, llrs[0], syndromes[0], out, 0.75, Z, 30);
+	decode_to_syndrome_into(ctx, 0, LDPC_algo::RSP, llrs[0], syndromes[0], out, 0.75, Z, 30);
+	decode_to_syndrome_into(ctx, 0, LDPC_algo::RNMS, llrs[0], syndromes[0], out, 0.75, Z, 30);
+	decode_compressed_ms_to_syndrome_into(ctx, 0, llrs[0], syndromes[0], out, MinSumCorrection::OFFSET, 0.5, 30);
+	decode_to_syndrome_into(ctx, 0, LDPC_algo::NMS, llrs[0], syndromes[0], out, float_params);
+
+	size_t converged_number{0};
+	size_t const allocations_before{allocations_count};
+	for (LDPC_algo alg_type : {LDPC_algo::SP, LDPC_algo::MS, LDPC_algo::NMS, LDPC_algo::LMS, LDPC_algo::LNMS, LDPC_algo::SSP, LDPC_algo::SNMS, LDPC_algo::RSP, LDPC_algo::RNMS}) {
+		for (size_t frame_number{0}; frame_number < llrs.size(); ++frame_number) {
+			DecodingStats stats{decode_to_syndrome_into(ctx, 0, alg_type, llrs[frame_number], syndromes[frame_number], out, 0.75, Z, 30)};
+			converged_number += stats.converged;
+			decode_into(ctx, 0, alg_type, llrs[frame_number], out, 0.75, Z, 30);
+		}
+	}
+	for (LDPC_algo alg_type : {LDPC_algo::SP, LDPC_algo::NMS, LDPC_algo::LNMS}) {
+		for (size_t frame_number{0}; frame_number < llrs.size(); ++frame_number) {
+			converged_number += decode_to_syndrome_into(ctx, 0, alg_type, llrs[frame_number], syndromes[frame_number], out, float_params).converged;
+		}
+	}
+	for (size_t frame_number{0}; frame_number < llrs.size(); ++frame_number) {
+		converged_number += decode_compressed_ms_to_syndrome_into(ctx, 0, llrs[frame_number], syndromes[frame_number], out, MinSumCorrection::NORMALIZED, 0.75, 30).converged;
+		converged_number += decode_compressed_ms_to_syndrome_into(ctx, 0, llrs[frame_number], syndromes[frame_number], out, MinSumCorrection::OFFSET, 0.5, 30).converged;
+	}
+	size_t const allocations_after{allocations_count};
+
+	CHECK( allocations_before > 0 ); // The counting allocation functions are in use
+	CHECK( allocations_after == allocations_before );
+	CHECK( converged_number > 0 );
+}
+
+#ifdef COUNT_C_ALLOCATIONS
+TEST_CASE("allocations outside operator new are counted") {
+	size_t const allocations_before{allocations_count};
+	void * volatile ptr{std::malloc(64)};
+	std::free(ptr);
+	CHECK( allocations_count == allocations_before + 1 );
+
+	Eigen::VectorXd vector(64);
+	vector.setZero();
+	CHECK( allocations_count == allocations_before + 2 ); // Eigen's aligned_malloc
+	CHECK( vector.sum() == 0.0 );
+}
+#endif
@@ -0,0 +1,965 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#ifndef CMAKE_BINARY_DIR
+#define CMAKE_BINARY_DIR ""
+#endif
+
+#include "decoders.h"
+#include "file-processor.h"
+#include "parallel-decoder.h"
+#include "context-kernels.hpp"
+#include "ldpc-utils.hpp"
+#include "quantized-kernels.hpp"
+#include "syndrome-tracker.hpp"
+
+#include <doctest/doctest.h>
+#include <Eigen/Sparse>
+#include <algorithm>
+#include <random>
+#include <sstream>
+
+
+// Top-left 4 x 14 part of 5G BG2
+Eigen::SparseMatrix<GF2, Eigen::RowMajor> small_bg2()
+{
+	return vec_to_sparse_m({{1, 1, 1, 1, 0, 0, 1, 0, 0, 1, 1, 1, 0, 0},
+	                        {1, 0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 0},
+	                        {1, 1, 0, 1, 1, 0, 0, 0, 1, 0, 1, 0, 1, 1},
+	                        {0, 1, 1, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 1},});
+}
+
+
+struct Frame
+{
+	Eigen::VectorX<GF2> word;
+	Eigen::VectorX<GF2> syndrome;
+	std::vector<LLR> llrs;
+};
+
+
+Frame make_frame(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& H, double ber, std::mt19937 & gen)
+{
+	std::bernoulli_distribution bit_distribution{0.5};
+	std::bernoulli_distribution error_distribution{ber};
+	double const llr_base_val{log((1.0 - ber) / ber)};
+
+	Frame frame;
+	frame.word.resize(H.cols());
+	for (GF2 & bit : frame.word) {
+		bit = bit_distribution(gen);
+	}
+	frame.syndrome = H * frame.word;
+	for (GF2 bit : frame.word) {
+		bool received{static_cast<bool>(bit) != error_distribution(gen)};
+		frame.llrs.push_back(received ? -llr_base_val : llr_base_val);
+	}
+	return frame;
+}
+
+
+TEST_SUITE_BEGIN("QC matrix");
+
+TEST_CASE("make_qc_matrix agrees with enhance_from_base and shift_eyes") {
+	size_t constexpr Z{16};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> bg{small_bg2()};
+
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{shift_eyes(enhance_from_base(bg, Z), Z, BG_type::BG2)};
+	QCMatrix qc{make_qc_matrix(bg, Z, BG_type::BG2)};
+
+	CHECK( qc.rows() == static_cast<size_t>(H.rows()) );
+	CHECK( qc.cols() == static_cast<size_t>(H.cols()) );
+	CHECK( qc.non_zeros() == static_cast<size_t>(H.nonZeros()) );
+	CHECK( Eigen::MatrixX<int>(qc.to_sparse().cast<int>()) == Eigen::MatrixX<int>(H.cast<int>()) );
+}
+
+TEST_CASE("qc_from_sparse recovers shifts of a lifted matrix") {
+	size_t constexpr Z{16};
+	QCMatrix qc{make_qc_matrix(small_bg2(), Z, BG_type::BG2)};
+	QCMatrix recovered{qc_from_sparse(qc.to_sparse(), Z)};
+
+	REQUIRE( recovered.blocks().size() == qc.blocks().size() );
+	for (size_t b{0}; b < qc.blocks().size(); ++b) {
+		CHECK( recovered.blocks()[b].row == qc.blocks()[b].row );
+		CHECK( recovered.blocks()[b].col == qc.blocks()[b].col );
+		CHECK( recovered.blocks()[b].shift == qc.blocks()[b].shift );
+	}
+
+	CHECK_THROWS( qc_from_sparse(qc.to_sparse(), 5) );
+}
+
+TEST_CASE("compute_shift reads the 5G tables and rejects entries outside them") {
+	CHECK( Z_c2iLS(384) == 1 );
+	CHECK( Z_c2iLS(15) == 7 );
+	CHECK_THROWS_AS( Z_c2iLS(17), std::runtime_error );
+	CHECK_THROWS_AS( Z_c2iLS(1000), std::runtime_error );
+
+	CHECK( compute_shift(0, 0, BG_type::BG1, 384) == 307 );
+	CHECK( compute_shift(0, 0, BG_type::BG1, 6) == 307 % 6 );
+	CHECK( compute_shift(0, 1, BG_type::BG2, 2) == 117 % 2 );
+	CHECK_THROWS_AS( compute_shift(0, 4, BG_type::BG1, 384), std::out_of_range ); // Zero block
+	CHECK_THROWS_AS( compute_shift(46, 0, BG_type::BG1, 384), std::out_of_range );
+	CHECK_THROWS_AS( compute_shift(0, 52, BG_type::BG2, 384), std::out_of_range );
+	CHECK_THROWS_AS( compute_shift(0, 0, BG_type::NOT_5G, 384), std::runtime_error );
+}
+
+TEST_CASE("shift_eyes rotates the rows of every non-zero block like the dense rotation") {
+	size_t constexpr Z{8};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{enhance_from_base(small_bg2(), Z)};
+	std::mt19937 gen{3};
+	std::uniform_int_distribution<size_t> offset_distribution{0, Z - 1};
+	for (size_t k{0}; k < 40; ++k) { // Extra entries inside the existing blocks
+		Eigen::SparseMatrix<GF2, Eigen::RowMajor>::InnerIterator it{H, static_cast<Eigen::Index>(gen() % H.rows())};
+		H.coeffRef(it.row(), it.col() / Z * Z + offset_distribution(gen)) = 1;
+	}
+	H.makeCompressed();
+
+	Eigen::MatrixX<int> expected{H.cast<int>()};
+	for (size_t eye_row{0}; eye_row < H.rows() / Z; ++eye_row) {
+		for (size_t eye_col{0}; eye_col < H.cols() / Z; ++eye_col) {
+			if (expected.block(eye_row * Z, eye_col * Z, Z, Z).isZero()) {
+				continue;
+			}
+			int shift{compute_shift(eye_row, eye_col, BG_type::BG2, Z)};
+			for (size_t i{eye_row * Z}; i < (eye_row + 1) * Z; ++i) {
+				auto row = expected.row(i).segment(eye_col * Z, Z);
+				std::rotate(row.begin(), row.begin() + shift, row.end());
+			}
+		}
+	}
+
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> shifted{shift_eyes(H, Z, BG_type::BG2)};
+	CHECK( shifted.isCompressed() );
+	CHECK( Eigen::MatrixX<int>(shifted.cast<int>()) == expected );
+}
+
+TEST_CASE("BG1 lifted with the largest Z is built straight from the shifts") {
+	size_t constexpr Z{384};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> bg{load_matrix_from_alist(CMAKE_BINARY_DIR + std::string("/src/coding/data/BG1.alist")).block(0, 0, 46, 68)};
+	QCMatrix qc{make_qc_matrix(bg, Z, BG_type::BG1)};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{qc.to_sparse()};
+
+	REQUIRE( H.rows() == 46 * Z );
+	REQUIRE( H.cols() == 68 * Z );
+	REQUIRE( H.nonZeros() == bg.nonZeros() * static_cast<Eigen::Index>(Z) );
+	CHECK( H.isCompressed() );
+
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> expected{shift_eyes(enhance_from_base(bg, Z), Z, BG_type::BG1)};
+	REQUIRE( expected.nonZeros() == H.nonZeros() );
+	CHECK( std::equal(H.outerIndexPtr(), H.outerIndexPtr() + H.rows() + 1, expected.outerIndexPtr()) );
+	CHECK( std::equal(H.innerIndexPtr(), H.innerIndexPtr() + H.nonZeros(), expected.innerIndexPtr()) );
+
+	QCMatrix recovered{qc_from_sparse(H, Z)};
+	REQUIRE( recovered.blocks().size() == qc.blocks().size() );
+	for (size_t b{0}; b < qc.blocks().size(); ++b) {
+		CHECK( recovered.blocks()[b].shift == qc.blocks()[b].shift );
+	}
+}
+
+TEST_SUITE_END();
+
+
+TEST_SUITE_BEGIN("QC decoder");
+
+TEST_CASE("decode_qc_nms_to_syndrome matches decode_nms_to_syndrome_r") {
+	size_t constexpr Z{16};
+	QCMatrix qc{make_qc_matrix(small_bg2(), Z, BG_type::BG2)};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{qc.to_sparse()};
+	MemoryManager mm{H, 1};
+
+	std::mt19937 gen{42};
+	for (double scale : {1.0, 0.75}) {
+		for (size_t frame_number{0}; frame_number < 50; ++frame_number) {
+			Frame frame{make_frame(H, 0.03, gen)};
+			Eigen::VectorX<GF2> expected{decode_nms_to_syndrome_r(H, frame.llrs, frame.syndrome, mm, 0, scale, 30)};
+			Eigen::VectorX<GF2> actual{decode_qc_nms_to_syndrome(qc, frame.llrs, frame.syndrome, scale, 30)};
+			CHECK( actual == expected );
+		}
+	}
+}
+
+TEST_SUITE_END();
+
+
+TEST_SUITE_BEGIN("Quantized decoder");
+
+template <typename T>
+void check_kernels_against_scalar(std::mt19937 & gen)
+{
+	std::uniform_int_distribution<int> val_distribution{-std::numeric_limits<T>::max(), std::numeric_limits<T>::max()};
+	for (size_t d{1}; d <= 40; ++d) {
+		std::vector<T> msg(d + 32);
+		for (size_t k{0}; k < d; ++k) {
+			msg[k] = static_cast<T>(val_distribution(gen) / (d % 3 ? 1 : 64)); // Small values give ties
+		}
+		CheckNodeMins<T> expected{check_node_mins_scalar(msg.data(), d)};
+		CheckNodeMins<T> actual{check_node_mins(msg.data(), d)};
+		CHECK( actual.min_1 == expected.min_1 );
+		CHECK( actual.min_2 == expected.min_2 );
+		CHECK( actual.min_1_pos == expected.min_1_pos );
+		CHECK( actual.sign == expected.sign );
+		CHECK( check_node_sign(msg.data(), d) == expected.sign );
+	}
+}
+
+TEST_CASE("check node kernels agree with scalar reference") {
+	std::mt19937 gen{7};
+	for (size_t repeat{0}; repeat < 20; ++repeat) {
+		check_kernels_against_scalar<int8_t>(gen);
+		check_kernels_against_scalar<int16_t>(gen);
+	}
+}
+
+TEST_CASE("quantized NMS FER is within 0.02 of double NMS") {
+	size_t constexpr Z{16};
+	size_t constexpr FRAMES{300};
+	QCMatrix qc{make_qc_matrix(small_bg2(), Z, BG_type::BG2)};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{qc.to_sparse()};
+	MemoryManager mm{H, 1};
+
+	std::mt19937 gen{42};
+	for (FixedPointFormat format : {FixedPointFormat{}, FixedPointFormat{12, 4, 3, 2}}) {
+		size_t double_failures{0};
+		size_t quantized_failures{0};
+		for (size_t frame_number{0}; frame_number < FRAMES; ++frame_number) {
+			Frame frame{make_frame(H, 0.03, gen)};
+			double_failures += !(decode_nms_to_syndrome_r(H, frame.llrs, frame.syndrome, mm, 0, 0.75, 30) == frame.word);
+			quantized_failures += !(decode_quantized_nms_to_syndrome(H, frame.llrs, frame.syndrome, format, 30) == frame.word);
+		}
+		MESSAGE("double FER: " << double(double_failures) / FRAMES << ", quantized FER: " << double(quantized_failures) / FRAMES);
+		CHECK( std::abs(double(quantized_failures) - double(double_failures)) / FRAMES <= 0.02 );
+	}
+
+	CHECK_THROWS( decode_quantized_nms_to_syndrome(H, std::vector<LLR>(H.cols()), Eigen::VectorX<GF2>::Zero(H.rows()), FixedPointFormat{17, 2, 3, 2}) );
+}
+
+TEST_SUITE_END();
+
+
+TEST_SUITE_BEGIN("Batch decoder");
+
+TEST_CASE("decode_nms_to_syndrome_batch matches frame-by-frame decoding") {
+	size_t constexpr Z{16};
+	size_t constexpr FRAMES{37};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(small_bg2(), Z, BG_type::BG2).to_sparse()};
+	MemoryManager mm{H, 1};
+
+	std::mt19937 gen{1};
+	std::vector<Frame> frames;
+	std::vector<std::vector<LLR>> llrs;
+	std::vector<Eigen::VectorX<GF2>> syndromes;
+	for (size_t frame_number{0}; frame_number < FRAMES; ++frame_number) {
+		frames.push_back(make_frame(H, 0.01 + 0.001 * frame_number, gen));
+		llrs.push_back(frames.back().llrs);
+		syndromes.push_back(frames.back().syndrome);
+	}
+
+	std::vector<BatchDecodingResult> results{decode_nms_to_syndrome_batch(H, llrs, syndromes, 0.75, 30)};
+
+	REQUIRE( results.size() == FRAMES );
+	for (size_t frame_number{0}; frame_number < FRAMES; ++frame_number) {
+		Eigen::VectorX<GF2> expected{decode_nms_to_syndrome_r(H, llrs[frame_number], syndromes[frame_number], mm, 0, 0.75, 30)};
+		CHECK( results[frame_number].word == expected );
+		CHECK( results[frame_number].syndrome_matches == (H * expected == syndromes[frame_number]) );
+		CHECK( results[frame_number].iterations >= 1 );
+		CHECK( results[frame_number].iterations <= 31 );
+	}
+
+	CHECK( decode_nms_to_syndrome_batch(H, {}, {}).empty() );
+}
+
+TEST_SUITE_END();
+
+
+TEST_SUITE_BEGIN("Decoder context");
+
+TEST_CASE("degree-specialized row minima agree with the generic scan") {
+	std::mt19937 gen{23};
+	std::uniform_int_distribution<int> val_distribution{-8, 8}; // Few distinct magnitudes give ties
+	for (uint32_t degree{1}; degree <= 24; ++degree) {
+		for (size_t repeat{0}; repeat < 50; ++repeat) {
+			std::vector<double> M(degree);
+			for (double & message : M) {
+				message = val_distribution(gen) / 4.0;
+			}
+			RowMins expected{row_mins(M.data(), degree)};
+			RowMins actual{row_mins_by_degree(M.data(), degree)};
+			CHECK( actual.min_1 == expected.min_1 );
+			CHECK( actual.min_2 == expected.min_2 );
+			CHECK( actual.min_1_pos == expected.min_1_pos );
+			CHECK( actual.sign == expected.sign );
+
+			std::vector<double> magnitudes(degree);
+			std::transform(M.begin(), M.end(), magnitudes.begin(), [](double message) { return std::abs(message); });
+			size_t first_min{static_cast<size_t>(std::min_element(magnitudes.begin(), magnitudes.end()) - magnitudes.begin())};
+			CHECK( actual.min_1_pos == first_min );
+			CHECK( actual.min_1 == magnitudes[first_min] );
+			if (degree > 1) {
+				magnitudes.erase(magnitudes.begin() + first_min);
+				CHECK( actual.min_2 == *std::min_element(magnitudes.begin(), magnitudes.end()) );
+			}
+		}
+	}
+}
+
+TEST_CASE("DecoderContext edge maps are consistent with H") {
+	size_t constexpr Z{16};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(small_bg2(), Z, BG_type::BG2).to_sparse()};
+	DecoderContext ctx{H, 2};
+
+	REQUIRE( ctx.rows() == static_cast<size_t>(H.rows()) );
+	REQUIRE( ctx.cols() == static_cast<size_t>(H.cols()) );
+	REQUIRE( ctx.non_zeros() == static_cast<size_t>(H.nonZeros()) );
+	CHECK( ctx.threads_number() == 2 );
+
+	for (size_t j{0}; j < ctx.rows(); ++j) {
+		CHECK( ctx.row_degrees()[j] == ctx.row_ptr()[j + 1] - ctx.row_ptr()[j] );
+		for (uint32_t e{ctx.row_ptr()[j]}; e < ctx.row_ptr()[j + 1]; ++e) {
+			CHECK( ctx.edge_row()[e] == j );
+			CHECK( H.coeff(j, ctx.edge_col()[e]) == GF2{1} );
+		}
+	}
+	for (size_t i{0}; i < ctx.cols(); ++i) {
+		CHECK( ctx.col_degrees()[i] == ctx.col_ptr()[i + 1] - ctx.col_ptr()[i] );
+		for (uint32_t k{ctx.col_ptr()[i]}; k < ctx.col_ptr()[i + 1]; ++k) {
+			uint32_t e{ctx.col_edges()[k]};
+			CHECK( ctx.edge_col()[e] == i );
+			CHECK( ctx.csr_to_csc()[e] == k );
+		}
+	}
+
+	CHECK_THROWS( ctx.scratch(2) );
+}
+
+TEST_CASE("context MS and NMS decoders match decode_nms_to_syndrome_r") {
+	size_t constexpr Z{16};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(small_bg2(), Z, BG_type::BG2).to_sparse()};
+	MemoryManager mm{H, 1};
+	DecoderContext ctx{H, 1};
+
+	std::mt19937 gen{7};
+	for (size_t frame_number{0}; frame_number < 50; ++frame_number) {
+		Frame frame{make_frame(H, 0.03, gen)};
+		CHECK( decode_to_syndrome(ctx, 0, LDPC_algo::MS, frame.llrs, frame.syndrome, 0.75, 1, 30) == decode_nms_to_syndrome_r(H, frame.llrs, frame.syndrome, mm, 0, 1.0, 30) );
+		CHECK( decode_to_syndrome(ctx, 0, LDPC_algo::NMS, frame.llrs, frame.syndrome, 0.75, 1, 30) == decode_nms_to_syndrome_r(H, frame.llrs, frame.syndrome, mm, 0, 0.75, 30) );
+	}
+
+}
+
+TEST_CASE("layered decoder accepts any layer size and tracks the syndrome incrementally") {
+	size_t constexpr Z{16};
+	size_t constexpr FRAMES{200};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(small_bg2(), Z, BG_type::BG2).to_sparse()};
+	DecoderContext ctx{H, 1};
+
+	std::mt19937 gen{5};
+	std::vector<GF2> out(H.cols());
+	size_t block_layer_errors{0}, partial_layer_errors{0};
+	for (size_t frame_number{0}; frame_number < FRAMES; ++frame_number) {
+		Frame frame{make_frame(H, 0.03, gen)};
+		Eigen::VectorX<GF2> block_layer_word{decode_to_syndrome(ctx, 0, LDPC_algo::LNMS, frame.llrs, frame.syndrome, 0.75, Z, 30)};
+		block_layer_errors += block_layer_word != frame.word;
+		CHECK( decode_lnms_to_syndrome(H, frame.llrs, frame.syndrome, Z, 0.75, 30) == block_layer_word );
+
+		DecodingStats stats{decode_to_syndrome_into(ctx, 0, LDPC_algo::LNMS, frame.llrs, frame.syndrome, out, 0.75, 24, 30)}; // 64 rows: layers of 24, 24 and 16
+		Eigen::VectorX<GF2> partial_layer_word{Eigen::Map<Eigen::VectorX<GF2>>(out.data(), out.size())};
+		partial_layer_errors += partial_layer_word != frame.word;
+		CHECK( stats.converged == (H * partial_layer_word == frame.syndrome) );
+		CHECK( stats.iterations <= 31 );
+	}
+
+	MESSAGE("LNMS frame errors: layer size " << Z << ": " << block_layer_errors << ", layer size 24: " << partial_layer_errors);
+	CHECK( std::abs(static_cast<double>(partial_layer_errors) - static_cast<double>(block_layer_errors)) / FRAMES <= 0.05 );
+	CHECK_THROWS( decode_to_syndrome(ctx, 0, LDPC_algo::LNMS, std::vector<LLR>(H.cols(), 1.0), Eigen::VectorX<GF2>::Zero(H.rows()), 0.75, 0) );
+}
+
+TEST_CASE("context SP decoder corrects as often as decode_sp_to_syndrome") {
+	size_t constexpr Z{16};
+	size_t constexpr FRAMES{200};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(small_bg2(), Z, BG_type::BG2).to_sparse()};
+	DecoderContext ctx{H, 1};
+
+	std::mt19937 gen{3};
+	size_t reference_errors{0}, context_errors{0}, codeword_errors{0};
+	for (size_t frame_number{0}; frame_number < FRAMES; ++frame_number) {
+		Frame frame{make_frame(H, 0.03, gen)};
+		reference_errors += decode_sp_to_syndrome(H, frame.llrs, frame.syndrome, 30) != frame.word;
+		context_errors += decode_to_syndrome(ctx, 0, LDPC_algo::SP, frame.llrs, frame.syndrome, 1.0, 1, 30) != frame.word;
+
+		// Codeword mode: all-zero word sent, errors are the ones of the frame
+		std::vector<LLR> llrs(H.cols());
+		for (size_t i{0}; i < llrs.size(); ++i) {
+			llrs[i] = frame.word[i] ? -static_cast<double>(frame.llrs[i]) : static_cast<double>(frame.llrs[i]);
+		}
+		codeword_errors += decode(ctx, 0, LDPC_algo::SP, llrs, 1.0, 1, 30) != Eigen::VectorX<GF2>::Zero(H.cols());
+	}
+
+	MESSAGE("SP frame errors: reference " << reference_errors << ", context " << context_errors << ", codeword mode " << codeword_errors);
+	CHECK( std::abs(static_cast<double>(context_errors) - static_cast<double>(reference_errors)) / FRAMES <= 0.02 );
+	CHECK( context_errors == codeword_errors );
+}
+
+TEST_CASE("offset min-sum and normalization schedules correct as often as NMS") {
+	size_t constexpr Z{16};
+	size_t constexpr FRAMES{200};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(small_bg2(), Z, BG_type::BG2).to_sparse()};
+	DecoderContext ctx{H, 1};
+
+	DecoderParams params;
+	params.layer_size = Z;
+	params.max_iters = 30;
+	DecoderParams constant_schedule{params};
+	constant_schedule.scale_by_iteration = {params.scale, params.scale};
+	DecoderParams degree_schedule{params};
+	degree_schedule.scale_by_degree.assign(H.cols(), 0.8); // Longer than any row degree
+	degree_schedule.scale_by_degree[6] = 0.7;
+
+	std::mt19937 gen{11};
+	size_t nms_errors{0}, oms_errors{0}, lnms_errors{0}, loms_errors{0}, degree_errors{0};
+	for (size_t frame_number{0}; frame_number < FRAMES; ++frame_number) {
+		Frame frame{make_frame(H, 0.03, gen)};
+		Eigen::VectorX<GF2> nms_word{decode_to_syndrome(ctx, 0, LDPC_algo::NMS, frame.llrs, frame.syndrome, params)};
+		nms_errors += nms_word != frame.word;
+		oms_errors += decode_to_syndrome(ctx, 0, LDPC_algo::OMS, frame.llrs, frame.syndrome, params) != frame.word;
+		lnms_errors += decode_to_syndrome(ctx, 0, LDPC_algo::LNMS, frame.llrs, frame.syndrome, params) != frame.word;
+		loms_errors += decode_to_syndrome(ctx, 0, LDPC_algo::LOMS, frame.llrs, frame.syndrome, params) != frame.word;
+		degree_errors += decode_to_syndrome(ctx, 0, LDPC_algo::NMS, frame.llrs, frame.syndrome, degree_schedule) != frame.word;
+		CHECK( decode_to_syndrome(ctx, 0, LDPC_algo::NMS, frame.llrs, frame.syndrome, constant_schedule) == nms_word );
+	}
+
+	MESSAGE("Frame errors: NMS " << nms_errors << ", OMS " << oms_errors << ", LNMS " << lnms_errors << ", LOMS " << loms_errors << ", NMS by degree " << degree_errors);
+	CHECK( std::abs(static_cast<double>(oms_errors) - static_cast<double>(nms_errors)) / FRAMES <= 0.05 );
+	CHECK( std::abs(static_cast<double>(loms_errors) - static_cast<double>(lnms_errors)) / FRAMES <= 0.05 );
+	CHECK( std::abs(static_cast<double>(degree_errors) - static_cast<double>(nms_errors)) / FRAMES <= 0.05 );
+
+	DecoderParams negative_offset{params};
+	negative_offset.offset = -0.5;
+	CHECK_THROWS( decode_to_syndrome(ctx, 0, LDPC_algo::OMS, std::vector<LLR>(H.cols(), 1.0), Eigen::VectorX<GF2>::Zero(H.rows()), negative_offset) );
+}
+
+TEST_CASE("traced decoding and legacy wrappers give the same words as the context decoders") {
+	size_t constexpr Z{16};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(small_bg2(), Z, BG_type::BG2).to_sparse()};
+	DecoderContext ctx{H, 1};
+
+	std::mt19937 gen{17};
+	for (size_t frame_number{0}; frame_number < 20; ++frame_number) {
+		Frame frame{make_frame(H, 0.03, gen)};
+		for (LDPC_algo alg_type : {LDPC_algo::SP, LDPC_algo::NMS, LDPC_algo::LOMS}) {
+			DecoderParams params;
+			params.layer_size = Z;
+			params.max_iters = 30;
+			Eigen::VectorX<GF2> word{decode_to_syndrome(ctx, 0, alg_type, frame.llrs, frame.syndrome, params)};
+
+			std::ostringstream trace;
+			params.trace = &trace;
+			CHECK( decode_to_syndrome(ctx, 0, alg_type, frame.llrs, frame.syndrome, params) == word );
+			CHECK( trace.str().find("Iteration 0:") != std::string::npos );
+			CHECK( (trace.str().find("Layer 0, rows from 0 to 15:") != std::string::npos) == (alg_type == LDPC_algo::LOMS) );
+		}
+		CHECK( decode_nms_to_syndrome(H, frame.llrs, frame.syndrome, 0.75, 30) == decode_to_syndrome(ctx, 0, LDPC_algo::NMS, frame.llrs, frame.syndrome, 0.75, 1, 30) );
+		CHECK( decode_normalized_min_sum(H, frame.llrs, 0.75, 30) == decode(ctx, 0, LDPC_algo::NMS, frame.llrs, 0.75, 1, 30) );
+	}
+}
+
+// Shuffled NMS recomputing every check message from scratch, reference for the running row minima
+Eigen::VectorX<GF2> naive_shuffled_nms(DecoderContext const& ctx, Frame const& frame, double scale, size_t group_size, size_t max_iters)
+{
+	std::vector<uint32_t> const& row_ptr{ctx.row_ptr()};
+	std::vector<double> M(ctx.non_zeros()), E(ctx.non_zeros());
+	for (size_t e{0}; e < ctx.non_zeros(); ++e) {
+		M[e] = frame.llrs[ctx.edge_col()[e]];
+	}
+	Eigen::VectorX<GF2> c(ctx.cols());
+	for (size_t I{0}; ; ++I) {
+		for (size_t col_begin{0}; col_begin < ctx.cols(); col_begin += group_size) {
+			size_t col_end{std::min(col_begin + group_size, ctx.cols())};
+			for (uint32_t p{ctx.col_ptr()[col_begin]}; p < ctx.col_ptr()[col_end]; ++p) {
+				uint32_t e{ctx.col_edges()[p]};
+				size_t j{ctx.edge_row()[e]};
+				double min{std::numeric_limits<double>::max()};
+				bool sign{static_cast<bool>(frame.syndrome[j])};
+				for (uint32_t f{row_ptr[j]}; f < row_ptr[j + 1]; ++f) {
+					if (f != e) {
+						min = std::min(min, std::abs(M[f]));
+						sign ^= M[f] < 0;
+					}
+				}
+				E[e] = sign ? -min * scale : min * scale;
+			}
+			for (size_t i{col_begin}; i < col_end; ++i) {
+				double L{0.0};
+				for (uint32_t p{ctx.col_ptr()[i]}; p < ctx.col_ptr()[i + 1]; ++p) {
+					L += E[ctx.col_edges()[p]];
+				}
+				L += static_cast<double>(frame.llrs[i]);
+				c[i] = L < 0;
+				for (uint32_t p{ctx.col_ptr()[i]}; p < ctx.col_ptr()[i + 1]; ++p) {
+					M[ctx.col_edges()[p]] = L - E[ctx.col_edges()[p]];
+				}
+			}
+			if (I == max_iters || ctx.H() * c == frame.syndrome) {
+				return c;
+			}
+		}
+	}
+}
+
+TEST_CASE("shuffled schedule matches flooding with one group and a naive reference with small groups") {
+	size_t constexpr Z{16};
+	size_t constexpr FRAMES{200};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(small_bg2(), Z, BG_type::BG2).to_sparse()};
+	DecoderContext ctx{H, 1};
+
+	DecoderParams params;
+	params.max_iters = 30;
+	DecoderParams one_group{params};
+	one_group.group_size = H.cols();
+
+	std::mt19937 gen{19};
+	std::vector<GF2> out(H.cols());
+	size_t flooding_errors{0}, shuffled_errors{0}, flooding_iterations{0}, shuffled_iterations{0};
+	for (size_t frame_number{0}; frame_number < FRAMES; ++frame_number) {
+		Frame frame{make_frame(H, 0.03, gen)};
+		for (auto [flooding_alg, shuffled_alg] : {std::pair{LDPC_algo::SP, LDPC_algo::SSP}, std::pair{LDPC_algo::NMS, LDPC_algo::SNMS}}) {
+			DecodingStats flooding_stats{decode_to_syndrome_into(ctx, 0, flooding_alg, frame.llrs, frame.syndrome, out, params)};
+			Eigen::VectorX<GF2> flooding_word{Eigen::Map<Eigen::VectorX<GF2>>(out.data(), out.size())};
+			DecodingStats one_group_stats{decode_to_syndrome_into(ctx, 0, shuffled_alg, frame.llrs, frame.syndrome, out, one_group)};
+			CHECK( Eigen::Map<Eigen::VectorX<GF2>>(out.data(), out.size()) == flooding_word );
+			CHECK( one_group_stats.iterations == flooding_stats.iterations );
+
+			DecodingStats shuffled_stats{decode_to_syndrome_into(ctx, 0, shuffled_alg, frame.llrs, frame.syndrome, out, params)};
+			Eigen::VectorX<GF2> shuffled_word{Eigen::Map<Eigen::VectorX<GF2>>(out.data(), out.size())};
+			flooding_errors += flooding_word != frame.word;
+			shuffled_errors += shuffled_word != frame.word;
+			if (flooding_stats.converged && shuffled_stats.converged) {
+				flooding_iterations += flooding_stats.iterations;
+				shuffled_iterations += shuffled_stats.iterations;
+			}
+		}
+
+		for (size_t group_size : {size_t{1}, Z}) {
+			DecoderParams grouped{params};
+			grouped.group_size = group_size;
+			CHECK( decode_to_syndrome(ctx, 0, LDPC_algo::SNMS, frame.llrs, frame.syndrome, grouped) == naive_shuffled_nms(ctx, frame, grouped.scale, group_size, 30) );
+		}
+	}
+
+	MESSAGE("Frame errors: flooding " << flooding_errors << ", shuffled " << shuffled_errors << "; iterations of frames both decode: flooding " << flooding_iterations << ", shuffled " << shuffled_iterations);
+	CHECK( shuffled_errors <= flooding_errors + FRAMES / 50 );
+	CHECK( shuffled_iterations * 4 < flooding_iterations * 3 );
+
+	DecoderParams no_group{params};
+	no_group.group_size = 0;
+	CHECK_THROWS( decode_to_syndrome(ctx, 0, LDPC_algo::SSP, std::vector<LLR>(H.cols(), 1.0), Eigen::VectorX<GF2>::Zero(H.rows()), no_group) );
+	CHECK( decode(ctx, 0, LDPC_algo::SNMS, std::vector<LLR>(H.cols(), 1.0), params) == Eigen::VectorX<GF2>::Zero(H.cols()) );
+}
+
+TEST_CASE("residual schedule rescues frames flooding fails with as many check node updates") {
+	size_t constexpr Z{16};
+	size_t constexpr FRAMES{200};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(small_bg2(), Z, BG_type::BG2).to_sparse()};
+	DecoderContext ctx{H, 1};
+
+	// Flooding updates every row once per iteration, so both schedules get (max_iters + 1) * rows() row updates at most
+	DecoderParams params;
+	params.max_iters = 30;
+
+	std::mt19937 gen{23};
+	std::vector<GF2> out(H.cols());
+	size_t flooding_errors{0}, residual_errors{0}, rescued{0}, sp_errors{0}, rsp_errors{0}, sp_rescued{0}, codeword_errors{0};
+	for (size_t frame_number{0}; frame_number < FRAMES; ++frame_number) {
+		Frame frame{make_frame(H, 0.04, gen)};
+		bool flooding_failed{decode_to_syndrome(ctx, 0, LDPC_algo::NMS, frame.llrs, frame.syndrome, params) != frame.word};
+		DecodingStats stats{decode_to_syndrome_into(ctx, 0, LDPC_algo::RNMS, frame.llrs, frame.syndrome, out, params)};
+		bool residual_failed{Eigen::Map<Eigen::VectorX<GF2>>(out.data(), out.size()) != frame.word};
+		CHECK( stats.iterations <= params.max_iters + 1 );
+		flooding_errors += flooding_failed;
+		residual_errors += residual_failed;
+		rescued += flooding_failed && !residual_failed;
+
+		bool sp_failed{decode_to_syndrome(ctx, 0, LDPC_algo::SP, frame.llrs, frame.syndrome, params) != frame.word};
+		stats = decode_to_syndrome_into(ctx, 0, LDPC_algo::RSP, frame.llrs, frame.syndrome, out, params);
+		bool rsp_failed{Eigen::Map<Eigen::VectorX<GF2>>(out.data(), out.size()) != frame.word};
+		CHECK( stats.iterations <= params.max_iters + 1 );
+		sp_errors += sp_failed;
+		rsp_errors += rsp_failed;
+		sp_rescued += sp_failed && !rsp_failed;
+
+		std::vector<LLR> llrs(H.cols());
+		for (size_t i{0}; i < llrs.size(); ++i) {
+			llrs[i] = frame.word[i] ? -static_cast<double>(frame.llrs[i]) : static_cast<double>(frame.llrs[i]);
+		}
+		codeword_errors += decode(ctx, 0, LDPC_algo::RNMS, llrs, params) != Eigen::VectorX<GF2>::Zero(H.cols());
+	}
+
+	MESSAGE("Frame errors: NMS " << flooding_errors << ", RNMS " << residual_errors << " (" << rescued << " rescued), SP " << sp_errors
+		<< ", RSP " << rsp_errors << " (" << sp_rescued << " rescued), RNMS codeword mode " << codeword_errors);
+	CHECK( rescued > 0 );
+	CHECK( codeword_errors == residual_errors );
+}
+
+TEST_CASE("warm start continues the previous decoding of the frame") {
+	size_t constexpr Z{16};
+	size_t constexpr FRAMES{100};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(small_bg2(), Z, BG_type::BG2).to_sparse()};
+	DecoderContext ctx{H, 1};
+
+	DecoderParams first;
+	first.max_iters = 4;
+	DecoderParams resumed{first};
+	resumed.max_iters = 5;
+	resumed.warm_start = true;
+	DecoderParams whole{first};
+	whole.max_iters = 10;
+
+	std::mt19937 gen{31};
+	std::vector<GF2> out(H.cols());
+	size_t resumed_frames{0};
+	for (size_t frame_number{0}; frame_number < FRAMES; ++frame_number) {
+		Frame frame{make_frame(H, 0.04, gen)};
+		DecodingStats whole_stats{decode_to_syndrome_into(ctx, 0, LDPC_algo::NMS, frame.llrs, frame.syndrome, out, whole)};
+		Eigen::VectorX<GF2> whole_word{Eigen::Map<Eigen::VectorX<GF2>>(out.data(), out.size())};
+		if (decode_to_syndrome_into(ctx, 0, LDPC_algo::NMS, frame.llrs, frame.syndrome, out, first).converged) {
+			continue;
+		}
+		// 5 + 6 check node updates of flooding make the 11 of the whole run
+		DecodingStats resumed_stats{decode_to_syndrome_into(ctx, 0, LDPC_algo::NMS, frame.llrs, frame.syndrome, out, resumed)};
+		CHECK( Eigen::Map<Eigen::VectorX<GF2>>(out.data(), out.size()) == whole_word );
+		CHECK( resumed_stats.converged == whole_stats.converged );
+		CHECK( resumed_stats.iterations + first.max_iters + 1 == whole_stats.iterations );
+		++resumed_frames;
+
+		// Any schedule may continue from the messages of any other one
+		for (LDPC_algo alg_type : {LDPC_algo::SP, LDPC_algo::LNMS, LDPC_algo::SNMS, LDPC_algo::RNMS}) {
+			decode_to_syndrome_into(ctx, 0, LDPC_algo::NMS, frame.llrs, frame.syndrome, out, first);
+			DecodingStats stats{decode_to_syndrome_into(ctx, 0, alg_type, frame.llrs, frame.syndrome, out, resumed)};
+			CHECK( stats.converged == (H * Eigen::Map<Eigen::VectorX<GF2>>(out.data(), out.size()) == frame.syndrome) );
+		}
+	}
+	MESSAGE("Frames resumed: " << resumed_frames);
+	CHECK( resumed_frames > 0 );
+
+	DecoderContext fresh_ctx{H, 1};
+	CHECK_THROWS( decode_to_syndrome(fresh_ctx, 0, LDPC_algo::SP, std::vector<LLR>(H.cols(), 1.0), Eigen::VectorX<GF2>::Zero(H.rows()), resumed) );
+}
+
+TEST_CASE("warm start refuses messages of another frame or precision") {
+	size_t constexpr Z{16};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(small_bg2(), Z, BG_type::BG2).to_sparse()};
+	DecoderContext ctx{H, 1};
+
+	DecoderParams first;
+	first.max_iters = 2;
+	DecoderParams float_first{first};
+	float_first.precision = MessagePrecision::FLOAT;
+	DecoderParams resumed{first};
+	resumed.warm_start = true;
+	DecoderParams float_resumed{float_first};
+	float_resumed.warm_start = true;
+
+	std::mt19937 gen{41};
+	Frame frame_a{make_frame(H, 0.04, gen)};
+	Frame frame_b{make_frame(H, 0.04, gen)};
+	std::vector<GF2> out(H.cols());
+
+	decode_to_syndrome_into(ctx, 0, LDPC_algo::NMS, frame_a.llrs, frame_a.syndrome, out, first);
+	CHECK_THROWS_AS( decode_to_syndrome_into(ctx, 0, LDPC_algo::NMS, frame_b.llrs, frame_b.syndrome, out, resumed), std::runtime_error );
+
+	// E still holds double messages of frame a
+	decode_to_syndrome_into(ctx, 0, LDPC_algo::NMS, frame_b.llrs, frame_b.syndrome, out, float_first);
+	CHECK_THROWS_AS( decode_to_syndrome_into(ctx, 0, LDPC_algo::NMS, frame_b.llrs, frame_b.syndrome, out, resumed), std::runtime_error );
+	decode_to_syndrome_into(ctx, 0, LDPC_algo::NMS, frame_b.llrs, frame_b.syndrome, out, float_first);
+	CHECK_NOTHROW( decode_to_syndrome_into(ctx, 0, LDPC_algo::NMS, frame_b.llrs, frame_b.syndrome, out, float_resumed) );
+
+	decode_compressed_ms_to_syndrome_into(ctx, 0, frame_b.llrs, frame_b.syndrome, out, MinSumCorrection::NORMALIZED, 0.75, 2);
+	CHECK_THROWS_AS( decode_to_syndrome_into(ctx, 0, LDPC_algo::NMS, frame_b.llrs, frame_b.syndrome, out, float_resumed), std::runtime_error );
+}
+
+TEST_CASE("stall detection abandons only failing frames and reports their unsatisfied checks") {
+	size_t constexpr Z{16};
+	size_t constexpr FRAMES{200};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(small_bg2(), Z, BG_type::BG2).to_sparse()};
+	DecoderContext ctx{H, 1};
+
+	DecoderParams params;
+	params.max_iters = 30;
+	params.layer_size = Z;
+	DecoderParams watched{params};
+
+	std::mt19937 gen{37};
+	std::vector<GF2> out(H.cols());
+	for (LDPC_algo alg_type : {LDPC_algo::NMS, LDPC_algo::LNMS, LDPC_algo::SNMS, LDPC_algo::RNMS}) {
+		// An iteration of the residual schedule commits only the few rows whose neighbourhoods fill rows() updates,
+		// so its unsatisfied checks stay flat for longer
+		watched.stall_window = alg_type == LDPC_algo::RNMS ? 12 : 8;
+		size_t errors{0}, watched_errors{0}, stalled{0}, iterations{0}, watched_iterations{0};
+		for (size_t frame_number{0}; frame_number < FRAMES; ++frame_number) {
+			Frame frame{make_frame(H, 0.05, gen)};
+			DecodingStats stats{decode_to_syndrome_into(ctx, 0, alg_type, frame.llrs, frame.syndrome, out, params)};
+			errors += Eigen::Map<Eigen::VectorX<GF2>>(out.data(), out.size()) != frame.word;
+			iterations += stats.iterations;
+
+			DecodingStats watched_stats{decode_to_syndrome_into(ctx, 0, alg_type, frame.llrs, frame.syndrome, out, watched)};
+			Eigen::VectorX<GF2> word{Eigen::Map<Eigen::VectorX<GF2>>(out.data(), out.size())};
+			watched_errors += word != frame.word;
+			watched_iterations += watched_stats.iterations;
+			stalled += watched_stats.stalled;
+			Eigen::VectorX<GF2> residual_syndrome{H * word + frame.syndrome};
+			CHECK( watched_stats.unsatisfied == static_cast<size_t>(std::count(residual_syndrome.begin(), residual_syndrome.end(), GF2{1})) );
+			if (watched_stats.stalled) {
+				CHECK( !watched_stats.converged );
+				CHECK( watched_stats.iterations <= params.max_iters );
+			}
+			else {
+				CHECK( watched_stats.converged == stats.converged );
+			}
+		}
+		MESSAGE("Algorithm " << static_cast<int>(alg_type) << ": frame errors " << errors << ", with stall detection " << watched_errors << " (" << stalled << " stalled), iterations " << iterations << " -> " << watched_iterations);
+		CHECK( stalled > 0 );
+		CHECK( watched_errors <= errors + FRAMES / 50 );
+		CHECK( watched_iterations < iterations );
+	}
+}
+
+TEST_CASE("float messages correct as often as double ones on the H_*.alist codes") {
+	std::mt19937 gen{5};
+	std::vector<GF2> out(1);
+	for (auto [name, ber] : {std::pair{"H_648_1_2", 0.07}, std::pair{"H_1296_5_6", 0.015}}) {
+		Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{load_matrix_from_alist(CMAKE_BINARY_DIR + std::string("/src/coding/data/") + name + ".alist")};
+		DecoderContext ctx{H, 1};
+		out.resize(H.cols());
+		std::vector<Frame> frames;
+		for (size_t frame_number{0}; frame_number < 100; ++frame_number) {
+			frames.push_back(make_frame(H, ber, gen));
+		}
+
+		for (LDPC_algo alg_type : {LDPC_algo::SP, LDPC_algo::NMS, LDPC_algo::LNMS}) {
+			DecoderParams params;
+			params.scale = 0.75;
+			params.max_iters = 30;
+			DecoderParams float_params{params};
+			float_params.precision = MessagePrecision::FLOAT;
+
+			size_t errors{0}, float_errors{0};
+			for (Frame const& frame : frames) {
+				decode_to_syndrome_into(ctx, 0, alg_type, frame.llrs, frame.syndrome, out, params);
+				errors += Eigen::Map<Eigen::VectorX<GF2>>(out.data(), out.size()) != frame.word;
+				DecodingStats stats{decode_to_syndrome_into(ctx, 0, alg_type, frame.llrs, frame.syndrome, out, float_params)};
+				Eigen::VectorX<GF2> word{Eigen::Map<Eigen::VectorX<GF2>>(out.data(), out.size())};
+				float_errors += word != frame.word;
+				CHECK( stats.converged == (H * word == frame.syndrome) );
+			}
+			MESSAGE(name << ", algorithm " << static_cast<int>(alg_type) << ": frame errors " << errors << ", float " << float_errors);
+			CHECK( errors > 0 );
+			CHECK( float_errors <= errors + frames.size() / 50 );
+		}
+	}
+
+	DecoderContext ctx{small_bg2(), 1};
+	DecoderParams params;
+	params.precision = MessagePrecision::FLOAT;
+	Frame frame{make_frame(small_bg2(), 0.05, gen)};
+	out.resize(ctx.cols());
+	CHECK_THROWS( decode_to_syndrome_into(ctx, 0, LDPC_algo::RNMS, frame.llrs, frame.syndrome, out, params) );
+}
+
+TEST_CASE("ResidualQueue keeps the largest priority on top") {
+	ResidualQueue queue;
+	queue.reset(50);
+	std::vector<double> priorities(50, 0.0);
+	std::mt19937 gen{29};
+	std::uniform_int_distribution<uint32_t> key_distribution{0, 49};
+	std::uniform_real_distribution<double> priority_distribution{0.0, 10.0};
+	for (size_t step{0}; step < 1000; ++step) {
+		uint32_t key{key_distribution(gen)};
+		priorities[key] = step % 7 == 0 ? 0.0 : priority_distribution(gen);
+		queue.update(key, priorities[key]);
+		CHECK( queue.top_priority() == *std::max_element(priorities.begin(), priorities.end()) );
+		CHECK( queue.priority(queue.top()) == queue.top_priority() );
+	}
+}
+
+TEST_CASE("packed syndrome and output give the same words as Eigen vectors") {
+	size_t constexpr Z{16};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(small_bg2(), Z, BG_type::BG2).to_sparse()};
+	DecoderContext ctx{H, 1};
+
+	std::mt19937 gen{15};
+	BitVector out(H.cols());
+	for (size_t frame_number{0}; frame_number < 20; ++frame_number) {
+		Frame frame{make_frame(H, 0.03, gen)};
+		for (LDPC_algo alg_type : {LDPC_algo::SP, LDPC_algo::NMS, LDPC_algo::LNMS}) {
+			Eigen::VectorX<GF2> word{decode_to_syndrome(ctx, 0, alg_type, frame.llrs, frame.syndrome, 0.75, Z, 30)};
+			decode_to_syndrome_into(ctx, 0, alg_type, frame.llrs, BitVector{frame.syndrome}, out, 0.75, Z, 30);
+			CHECK( out == BitVector{word} );
+		}
+	}
+}
+
+TEST_CASE("compressed check node storage gives the same words as per-edge messages") {
+	size_t constexpr Z{16};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(small_bg2(), Z, BG_type::BG2).to_sparse()};
+	DecoderContext ctx{H, 1};
+
+	std::mt19937 gen{9};
+	for (size_t frame_number{0}; frame_number < 50; ++frame_number) {
+		Frame frame{make_frame(H, 0.03, gen)};
+		Eigen::VectorX<GF2> nms{decode_to_syndrome(ctx, 0, LDPC_algo::NMS, frame.llrs, frame.syndrome, 0.75, 1, 30)};
+		Eigen::VectorX<GF2> ms{decode_to_syndrome(ctx, 0, LDPC_algo::MS, frame.llrs, frame.syndrome, 1.0, 1, 30)};
+		CHECK( decode_compressed_ms_to_syndrome(ctx, 0, frame.llrs, frame.syndrome, MinSumCorrection::NORMALIZED, 0.75, 30) == nms );
+		CHECK( decode_compressed_ms_to_syndrome(ctx, 0, frame.llrs, frame.syndrome, MinSumCorrection::OFFSET, 0.0, 30) == ms );
+	}
+}
+
+TEST_SUITE_END();
+
+
+TEST_SUITE_BEGIN("Sum-product approximation");
+
+TEST_CASE("phi tables stay within their documented accuracy") {
+	PhiTable<double> linear{PhiAccuracy::LINEAR};
+	PhiTable<float> linear_float{PhiAccuracy::LINEAR};
+	PhiTable<float> table{PhiAccuracy::TABLE};
+	double linear_error{0.0}, linear_float_error{0.0}, table_error{0.0};
+	for (double x{0.25}; x < 20.0; x += 0.001) {
+		double exact{PhiTable<double>::exact(x)};
+		linear_error = std::max(linear_error, std::abs(linear(x) - exact));
+		linear_float_error = std::max(linear_float_error, std::abs(linear_float(static_cast<float>(x)) - exact));
+		table_error = std::max(table_error, std::abs(table(static_cast<float>(x)) - exact));
+	}
+	MESSAGE("phi max errors: linear " << linear_error << ", linear float " << linear_float_error << ", table " << table_error);
+	CHECK( linear_error < 1e-3 );
+	CHECK( linear_float_error < 1e-3 );
+	CHECK( table_error < 0.04 );
+	CHECK( table(0.0f) == doctest::Approx(PhiTable<double>::exact(1.0 / 8192)).epsilon(1e-6) );
+	CHECK( linear(-1e-9) == linear(0.0) );
+
+	FixedPointPhiTable fixed{8, 3};
+	CHECK( fixed.phi_fraction_bits() == 9 );
+	CHECK( fixed.backward(0) == 127 );
+	CHECK( fixed.backward(1 << 20) == 0 );
+	for (int32_t q{1}; q < 128; ++q) {
+		CHECK( std::abs(fixed.forward(q) - PhiTable<double>::exact(q / 8.0) * 512.0) <= 0.5 );
+		CHECK( std::abs(fixed.backward(q) - std::min(PhiTable<double>::exact(q / 512.0) * 8.0, 127.0)) <= 0.5 );
+	}
+	CHECK_THROWS( FixedPointPhiTable(8, 8) );
+}
+
+TEST_CASE("approximated sum-product decoders correct as often as the exact one") {
+	size_t constexpr Z{16};
+	size_t constexpr FRAMES{200};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(small_bg2(), Z, BG_type::BG2).to_sparse()};
+	DecoderContext ctx{H, 1};
+	PhiTable<double> const exact{PhiAccuracy::EXACT};
+	PhiTable<float> const linear{PhiAccuracy::LINEAR};
+	PhiTable<float> const table{PhiAccuracy::TABLE};
+
+	std::mt19937 gen{17};
+	size_t exact_errors{0}, linear_errors{0}, table_errors{0}, fixed_errors{0};
+	for (size_t frame_number{0}; frame_number < FRAMES; ++frame_number) {
+		Frame frame{make_frame(H, 0.03, gen)};
+		Eigen::VectorX<GF2> reference{decode_to_syndrome(ctx, 0, LDPC_algo::SP, frame.llrs, frame.syndrome, 1.0, 1, 30)};
+		CHECK( decode_sp_to_syndrome(ctx, 0, frame.llrs, frame.syndrome, exact, 30) == reference );
+		exact_errors += reference != frame.word;
+		linear_errors += decode_sp_to_syndrome(ctx, 0, frame.llrs, frame.syndrome, linear, 30) != frame.word;
+		table_errors += decode_sp_to_syndrome(ctx, 0, frame.llrs, frame.syndrome, table, 30) != frame.word;
+		fixed_errors += decode_quantized_sp_to_syndrome(H, frame.llrs, frame.syndrome, {8, 3}, 30) != frame.word;
+	}
+
+	MESSAGE("SP frame errors: exact " << exact_errors << ", linear " << linear_errors << ", table " << table_errors << ", fixed point " << fixed_errors);
+	CHECK( std::abs(static_cast<double>(linear_errors) - static_cast<double>(exact_errors)) / FRAMES <= 0.02 );
+	CHECK( std::abs(static_cast<double>(table_errors) - static_cast<double>(exact_errors)) / FRAMES <= 0.03 );
+	CHECK( std::abs(static_cast<double>(fixed_errors) - static_cast<double>(exact_errors)) / FRAMES <= 0.03 );
+}
+
+TEST_SUITE_END();
+
+
+TEST_SUITE_BEGIN("Parallel decoder");
+
+TEST_CASE("parallel decoder matches the serial context decoders") {
+	size_t constexpr Z{16};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(small_bg2(), Z, BG_type::BG2).to_sparse()};
+	DecoderContext ctx{H, 2};
+	ParallelDecoder parallel_decoder{ctx, 3};
+
+	std::mt19937 gen{13};
+	std::vector<GF2> out(H.cols());
+	for (size_t frame_number{0}; frame_number < 50; ++frame_number) {
+		Frame frame{make_frame(H, 0.03, gen)};
+		for (LDPC_algo alg_type : {LDPC_algo::SP, LDPC_algo::MS, LDPC_algo::NMS, LDPC_algo::OMS, LDPC_algo::LMS, LDPC_algo::LNMS, LDPC_algo::LOMS}) {
+			DecodingStats serial_stats{decode_to_syndrome_into(ctx, 0, alg_type, frame.llrs, frame.syndrome, out, 0.75, Z, 30)};
+			Eigen::VectorX<GF2> serial_word{Eigen::Map<Eigen::VectorX<GF2>>(out.data(), out.size())};
+			DecodingStats parallel_stats{parallel_decoder.decode_to_syndrome_into(1, alg_type, frame.llrs, frame.syndrome, out, 0.75, Z, 30)};
+			CHECK( Eigen::Map<Eigen::VectorX<GF2>>(out.data(), out.size()) == serial_word );
+			CHECK( parallel_stats.converged == serial_stats.converged );
+			CHECK( parallel_stats.iterations == serial_stats.iterations );
+		}
+	}
+}
+
+TEST_CASE("parallel layered decoder rejects layers sharing variables") {
+	size_t constexpr Z{16};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(small_bg2(), Z, BG_type::BG2).to_sparse()};
+	DecoderContext ctx{H, 1};
+	ParallelDecoder parallel_decoder{ctx, 2};
+
+	std::vector<LLR> llrs(H.cols(), 1.0);
+	Eigen::VectorX<GF2> s{Eigen::VectorX<GF2>::Zero(H.rows())};
+	CHECK_THROWS( parallel_decoder.decode_to_syndrome(0, LDPC_algo::LNMS, llrs, s, 0.75, 2 * Z) );
+	CHECK_THROWS( parallel_decoder.decode_to_syndrome(0, LDPC_algo::LNMS, llrs, s, 0.75, 0) );
+	CHECK( parallel_decoder.decode_to_syndrome(0, LDPC_algo::NMS, llrs, s, 0.75, 2 * Z) == Eigen::VectorX<GF2>::Zero(H.cols()) );
+	CHECK_THROWS( parallel_decoder.decode_to_syndrome(0, LDPC_algo::SNMS, llrs, s) );
+	CHECK_THROWS( parallel_decoder.decode_to_syndrome(0, LDPC_algo::RNMS, llrs, s) );
+	DecoderParams warm;
+	warm.warm_start = true;
+	std::vector<GF2> out(H.cols());
+	CHECK_THROWS( parallel_decoder.decode_to_syndrome_into(0, LDPC_algo::NMS, llrs, s, out, warm) );
+	CHECK_THROWS( ParallelDecoder(ctx, 0) );
+}
+
+TEST_SUITE_END();
+
+
+TEST_SUITE_BEGIN("Syndrome tracker");
+
+TEST_CASE("SyndromeTracker follows H * c under random flips") {
+	size_t constexpr Z{16};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(small_bg2(), Z, BG_type::BG2).to_sparse()};
+	std::vector<int> col_ptr, col_rows;
+	std::tie(col_ptr, col_rows) = make_csc_index(H);
+	auto rows_of = [&](size_t i, auto f) {
+		for (int k{col_ptr[i]}; k < col_ptr[i + 1]; ++k) {
+			f(col_rows[k]);
+		}
+	};
+
+	std::mt19937 gen{13};
+	Frame frame{make_frame(H, 0.03, gen)};
+	SyndromeTracker syndrome;
+	syndrome.reset(H.rows(), H.cols(), frame.syndrome);
+
+	Eigen::VectorX<GF2> c{Eigen::VectorX<GF2>::Zero(H.cols())};
+	std::uniform_int_distribution<size_t> bit_distribution{0, static_cast<size_t>(H.cols() - 1)};
+	for (size_t step{0}; step < 200; ++step) {
+		size_t i{bit_distribution(gen)};
+		c[i] += GF2{1};
+		syndrome.set(i, static_cast<bool>(c[i]), rows_of);
+		syndrome.set(i, static_cast<bool>(c[i]), rows_of); // Setting the same value again is a no-op
+
+		Eigen::VectorX<GF2> parity{H * c + frame.syndrome};
+		size_t unsatisfied{0};
+		for (GF2 bit : parity) {
+			unsatisfied += static_cast<bool>(bit);
+		}
+		CHECK( syndrome.unsatisfied() == unsatisfied );
+		CHECK( syndrome.flips() == step + 1 );
+	}
+
+	for (size_t i{0}; i < static_cast<size_t>(H.cols()); ++i) {
+		syndrome.set(i, static_cast<bool>(frame.word[i]), rows_of);
+	}
+	CHECK( syndrome.satisfied() );
+}
+
+TEST_SUITE_END();
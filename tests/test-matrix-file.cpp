@@ -0,0 +1,207 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#ifndef CMAKE_BINARY_DIR
+#define CMAKE_BINARY_DIR ""
+#endif
+
+#include "matrix-file.h"
+#include "lifted-matrix-cache.h"
+#include "file-processor.h"
+#include "alist_matrix.h"
+
+#include <doctest/doctest.h>
+#include <Eigen/Sparse>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+
+// Fresh directory for the files of one test case
+std::filesystem::path test_directory(std::string const& name)
+{
+	std::filesystem::path directory{std::filesystem::temp_directory_path() / ("test-matrix-file-" + name)};
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+	return directory;
+}
+
+
+// Replaces the index-th uint32 of the arrays of a matrix file
+void overwrite_index(std::string const& filename, size_t index, uint32_t value)
+{
+	std::fstream file{filename, std::ios::binary | std::ios::in | std::ios::out};
+	file.seekp(sizeof(MatrixFileHeader) + index * sizeof(uint32_t));
+	file.write(reinterpret_cast<char const*>(&value), sizeof(value));
+}
+
+
+bool same_matrix(Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& a, Eigen::SparseMatrix<GF2, Eigen::RowMajor> const& b)
+{
+	return BinarySparseMatrix{a} == BinarySparseMatrix{b};
+}
+
+
+TEST_CASE("binary matrix files map back to the saved matrix") {
+	std::filesystem::path directory{test_directory("round-trip")};
+	std::mt19937 gen{11};
+	std::vector<std::pair<uint32_t, uint32_t>> entries;
+	for (size_t k{0}; k < 400; ++k) {
+		entries.emplace_back(gen() % 50, gen() % 120);
+	}
+	BinarySparseMatrix H{50, 120, entries};
+
+	std::string const filename{(directory / "H.ldpcm").string()};
+	save_matrix_binary(H, filename, 42);
+	MappedMatrixFile file{filename};
+	CHECK( file.rows() == 50 );
+	CHECK( file.cols() == 120 );
+	CHECK( file.non_zeros() == H.non_zeros() );
+	CHECK( file.key() == 42 );
+	CHECK( std::equal(file.col_ptr().begin(), file.col_ptr().end(), H.col_ptr().begin()) );
+	CHECK( std::equal(file.row_indices().begin(), file.row_indices().end(), H.row_indices().begin()) );
+	CHECK( file.to_binary_sparse() == H );
+	CHECK( same_matrix(load_matrix_binary(filename), H.to_eigen()) );
+	CHECK( is_matrix_binary_file(filename) );
+	CHECK( same_matrix(load_matrix(filename), H.to_eigen()) );
+}
+
+TEST_CASE("malformed binary matrix files are rejected") {
+	std::filesystem::path directory{test_directory("malformed")};
+	BinarySparseMatrix H{4, 6, {{0, 1}, {1, 2}, {3, 5}}};
+	std::string const filename{(directory / "H.ldpcm").string()};
+	save_matrix_binary(H, filename);
+
+	// Entry (0, 1) of the CSC side moved to row 2: both sides stay sorted and in range but disagree
+	overwrite_index(filename, 5 + 3 + 7, 2);
+	CHECK_THROWS_AS( MappedMatrixFile{filename}, std::runtime_error );
+	CHECK_THROWS_AS( load_matrix_binary(filename), std::runtime_error );
+	CHECK_THROWS_AS( load_matrix(filename), std::runtime_error );
+	save_matrix_binary(H, filename);
+	overwrite_index(filename, 5, 0x7fffffff); // First column index
+	CHECK_THROWS_AS( MappedMatrixFile{filename}, std::runtime_error );
+
+	std::filesystem::resize_file(filename, std::filesystem::file_size(filename) - 4);
+	CHECK_THROWS_AS( MappedMatrixFile{filename}, std::runtime_error );
+	std::filesystem::resize_file(filename, 10);
+	CHECK_THROWS_AS( MappedMatrixFile{filename}, std::runtime_error );
+
+	std::ofstream{filename} << "3 2\n";
+	CHECK( !is_matrix_binary_file(filename) );
+	CHECK_THROWS_AS( MappedMatrixFile{filename}, std::runtime_error );
+	CHECK_THROWS_AS( MappedMatrixFile{(directory / "missing.ldpcm").string()}, std::runtime_error );
+}
+
+TEST_CASE("alist files convert to binary ones and back") {
+	std::filesystem::path directory{test_directory("alist")};
+	std::string const alist_filename{CMAKE_BINARY_DIR + std::string("/src/coding/data/H_648_1_2.alist")};
+	std::string const binary_filename{(directory / "H_648_1_2.ldpcm").string()};
+	std::string const back_filename{(directory / "H_648_1_2.alist").string()};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{load_matrix_from_alist(alist_filename)};
+
+	alist_to_binary(alist_filename, binary_filename);
+	CHECK( same_matrix(load_matrix_binary(binary_filename), H) );
+	CHECK( same_matrix(load_matrix(alist_filename), H) );
+
+	binary_to_alist(binary_filename, back_filename);
+	CHECK( same_matrix(load_matrix_from_alist(back_filename), H) );
+}
+
+TEST_CASE("lifted matrix cache stores every lifting under its own key") {
+	std::filesystem::path directory{test_directory("cache")};
+	size_t constexpr Z{16};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> bg{load_matrix_from_alist(CMAKE_BINARY_DIR + std::string("/src/coding/data/BG2.alist"))};
+	LiftedMatrixCache cache{directory};
+
+	uint64_t const key{LiftedMatrixCache::key(bg, Z, BG_type::BG2, shift_randomness::NO_RANDOM, 0)};
+	CHECK( key == LiftedMatrixCache::key(bg, Z, BG_type::BG2, shift_randomness::NO_RANDOM, 5) ); // Seed matters for random shifts only
+	CHECK( key != LiftedMatrixCache::key(bg, 2 * Z, BG_type::BG2, shift_randomness::NO_RANDOM, 0) );
+	CHECK( key != LiftedMatrixCache::key(bg, Z, BG_type::BG2, shift_randomness::RANDOM, 0) );
+	CHECK( !std::filesystem::exists(cache.path(key)) );
+
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> expected{make_qc_matrix(bg, Z, BG_type::BG2).to_sparse()};
+	CHECK( same_matrix(cache.lift(bg, Z, BG_type::BG2), expected) );
+	REQUIRE( std::filesystem::exists(cache.path(key)) );
+	CHECK( MappedMatrixFile{cache.path(key).string()}.key() == key );
+	CHECK( same_matrix(LiftedMatrixCache{directory}.lift(bg, Z, BG_type::BG2), expected) );
+
+	std::filesystem::resize_file(cache.path(key), 20); // Damaged files are lifted again
+	CHECK( same_matrix(cache.lift(bg, Z, BG_type::BG2), expected) );
+	CHECK( MappedMatrixFile{cache.path(key).string()}.key() == key );
+	overwrite_index(cache.path(key).string(), bg.rows() * Z + 1, 0x7fffffff); // Column index, size unchanged
+	CHECK( same_matrix(cache.lift(bg, Z, BG_type::BG2), expected) );
+	CHECK( MappedMatrixFile{cache.path(key).string()}.to_eigen().cols() == bg.cols() * static_cast<Eigen::Index>(Z) );
+
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> random{cache.lift(bg, Z, BG_type::BG2, shift_randomness::RANDOM, 7)};
+	std::filesystem::remove(cache.path(LiftedMatrixCache::key(bg, Z, BG_type::BG2, shift_randomness::RANDOM, 7)));
+	CHECK( same_matrix(cache.lift(bg, Z, BG_type::BG2, shift_randomness::RANDOM, 7), random) ); // Reproduced from the seed
+	CHECK( !same_matrix(cache.lift(bg, Z, BG_type::BG2, shift_randomness::RANDOM, 8), random) );
+	CHECK( std::distance(std::filesystem::directory_iterator{directory}, std::filesystem::directory_iterator{}) == 3 );
+}
+
+TEST_CASE("streaming alist reader and writer agree with the dense alist paths") {
+	std::filesystem::path directory{test_directory("alist-stream")};
+	for (std::string name : {"BG1", "BG2", "H_648_1_2", "H_1296_5_6"}) {
+		std::string const filename{CMAKE_BINARY_DIR + std::string("/src/coding/data/") + name + ".alist"};
+		alist_matrix matrix_alist;
+		REQUIRE( read_alist(filename, matrix_alist) == 0 );
+		Eigen::Matrix<GF2, Eigen::Dynamic, Eigen::Dynamic> dense{alist_to_matrix(matrix_alist)};
+
+		Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{read_alist_sparse(filename)};
+		CHECK( H.isCompressed() );
+		CHECK( Eigen::MatrixX<int>(H.cast<int>()) == dense.cast<int>() );
+
+		std::string const written{(directory / (name + ".alist")).string()};
+		write_alist_sparse(H, written);
+		std::ifstream file{written};
+		std::string const text{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+		CHECK( text == matrix_to_alist_string(dense) );
+	}
+}
+
+TEST_CASE("streaming alist reader rejects malformed files") {
+	std::filesystem::path directory{test_directory("alist-malformed")};
+	std::string const filename{(directory / "H.alist").string()};
+	auto read_text = [&filename](std::string const& text) {
+		std::ofstream{filename} << text;
+		return read_alist_sparse(filename);
+	};
+
+	// 2 x 3 matrix with ones at (0, 0), (0, 2) and (1, 1), zero padded
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{read_text("3 2\n1 2\n1 1 1\n2 1\n1\n2\n1\n1 3\n2 0\n")};
+	CHECK( Eigen::MatrixX<int>(H.cast<int>()) == (Eigen::MatrixX<int>(2, 3) << 1, 0, 1, 0, 1, 0).finished() );
+
+	CHECK_THROWS_AS( read_text("3 2\n1 2\n1 1 1\n2 1\n1\n2\n1\n1 3\n"), std::runtime_error ); // Truncated
+	CHECK_THROWS_AS( read_text("3 2\n1 2\n1 1 1\n2 1\n1\n2\n2\n1 3\n2 0\n"), std::runtime_error ); // Column lists against row weights
+	CHECK_THROWS_AS( read_text("3 2\n1 2\n1 1 1\n2 1\n1\n2\n1\n1 2\n2 0\n"), std::runtime_error ); // Row lists against column lists
+	CHECK_THROWS_AS( read_text("3 2\n1 2\n1 1 1\n2 1\n1\n2\n3\n1 3\n2 0\n"), std::runtime_error ); // Row out of range
+	CHECK_THROWS_AS( read_text("3 2\n1 2\n1 1 1\n2 1\n1\n2\n1\n1 1\n2 0\n"), std::runtime_error ); // Row list repeats a column
+	CHECK_THROWS_AS( read_text("3 2\n1 2\n1 1 1\n2147483647 2147483647\n"), std::runtime_error ); // Row weights overflow
+	CHECK_THROWS_AS( read_text("3 2\n1 2\n1 1 x\n"), std::runtime_error );
+	CHECK_THROWS_WITH( read_alist_sparse((directory / "missing.alist").string()),
+		("read_alist: file \"" + (directory / "missing.alist").string() + "\" not found!").c_str() );
+}
+
+TEST_CASE("alist files of 10^5 columns round-trip through the streaming paths") {
+	std::filesystem::path directory{test_directory("alist-large")};
+	size_t constexpr COLS{100000};
+	std::mt19937 gen{13};
+	std::vector<std::pair<uint32_t, uint32_t>> entries;
+	for (uint32_t i{0}; i < COLS; ++i) {
+		for (size_t k{0}; k < 3; ++k) {
+			entries.emplace_back(gen() % (COLS / 2), i);
+		}
+	}
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{BinarySparseMatrix{COLS / 2, COLS, entries}.to_eigen()};
+	std::string const filename{(directory / "H.alist").string()};
+
+	auto start{std::chrono::steady_clock::now()};
+	write_alist_sparse(H, filename);
+	auto written{std::chrono::steady_clock::now()};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> loaded{read_alist_sparse(filename)};
+	auto read{std::chrono::steady_clock::now()};
+	MESSAGE("alist of " << H.nonZeros() << " ones: written in " << std::chrono::duration<double, std::milli>(written - start).count()
+		<< " ms, read in " << std::chrono::duration<double, std::milli>(read - written).count() << " ms");
+	CHECK( same_matrix(loaded, H) );
+}
@@ -0,0 +1,136 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#ifndef CMAKE_BINARY_DIR
+#define CMAKE_BINARY_DIR ""
+#endif
+
+#include "tanner-cycles.h"
+#include "file-processor.h"
+
+#include <doctest/doctest.h>
+#include <chrono>
+#include <random>
+
+
+// Cycles of lengths 4, 6 and 8 by depth-first search over all simple paths from the lowest variable node of each cycle
+std::array<uint64_t, 3> brute_force_cycles(BinarySparseMatrix const& H)
+{
+	std::array<uint64_t, 3> cycles{};
+	std::vector<bool> on_path(H.cols() + H.rows(), false);
+	// Nodes: variable i is i, check j is cols + j
+	auto dfs = [&](auto const& self, uint32_t start, uint32_t node, size_t length) -> void {
+		bool const is_variable{node < H.cols()};
+		auto step = [&](uint32_t next) {
+			if (next == start && length >= 3) {
+				if (length + 1 <= 8) {
+					++cycles[(length + 1) / 2 - 2];
+				}
+				return;
+			}
+			if (on_path[next] || (next < H.cols() && next < start) || length + 1 >= 8) {
+				return;
+			}
+			on_path[next] = true;
+			self(self, start, next, length + 1);
+			on_path[next] = false;
+		};
+		if (is_variable) {
+			for (uint32_t j : H.col(node)) {
+				step(static_cast<uint32_t>(H.cols() + j));
+			}
+		}
+		else {
+			for (uint32_t i : H.row(node - H.cols())) {
+				step(i);
+			}
+		}
+	};
+	for (uint32_t v{0}; v < H.cols(); ++v) {
+		on_path[v] = true;
+		dfs(dfs, v, v, 0);
+		on_path[v] = false;
+	}
+	for (uint64_t & count : cycles) {
+		count /= 2; // Both directions
+	}
+	return cycles;
+}
+
+
+TEST_CASE("short cycles of small random matrices match exhaustive search") {
+	std::mt19937 gen{17};
+	for (size_t trial{0}; trial < 20; ++trial) {
+		size_t const rows{4 + gen() % 6}, cols{rows + 2 + gen() % 8};
+		std::vector<std::pair<uint32_t, uint32_t>> entries;
+		for (size_t k{0}; k < 3 * cols; ++k) {
+			entries.emplace_back(gen() % rows, gen() % cols);
+		}
+		BinarySparseMatrix H{rows, cols, entries};
+		std::array<uint64_t, 3> expected{brute_force_cycles(H)};
+		for (size_t threads_number : {1, 3}) {
+			CycleStats stats{count_cycles(H, threads_number)};
+			CHECK( stats.cycles_4 == expected[0] );
+			CHECK( stats.cycles_6 == expected[1] );
+			CHECK( stats.cycles_8 == expected[2] );
+			CHECK( stats.girth == (expected[0] ? 4 : expected[1] ? 6 : expected[2] ? 8 : stats.girth) );
+		}
+	}
+}
+
+TEST_CASE("girth beyond 8 and graphs without cycles") {
+	// Rows i and i + 1 share column i: one cycle through all 6 rows and columns
+	std::vector<std::pair<uint32_t, uint32_t>> ring;
+	for (uint32_t i{0}; i < 6; ++i) {
+		ring.emplace_back(i, i);
+		ring.emplace_back((i + 1) % 6, i);
+	}
+	CycleStats stats{count_cycles(BinarySparseMatrix{6, 6, ring}, 2)};
+	CHECK( stats.girth == 12 );
+	CHECK( stats.cycles_4 + stats.cycles_6 + stats.cycles_8 == 0 );
+
+	ring.pop_back(); // Path
+	CHECK( count_cycles(BinarySparseMatrix{6, 6, ring}).girth == 0 );
+	CHECK_THROWS_AS( count_cycles(BinarySparseMatrix{6, 6, ring}, 0), std::runtime_error );
+
+	// Base 4-cycle with shift sum s lifts to cycles of length 4 * Z / gcd(Z, s) only
+	QCMatrix qc{2, 2, 10, {{0, 0, 0}, {0, 1, 0}, {1, 0, 0}, {1, 1, 4}}};
+	CHECK( count_cycles(qc).girth == 20 );
+	CHECK( count_cycles(BinarySparseMatrix{qc.to_sparse()}).girth == 20 );
+}
+
+TEST_CASE("QC matrices counted from the base graph agree with their lifted matrices") {
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> bg{load_matrix_from_alist(CMAKE_BINARY_DIR + std::string("/src/coding/data/BG2.alist"))};
+	std::mt19937 engine{23};
+	for (size_t Z : {2, 3, 5, 8, 16}) {
+		for (shift_randomness rnd : {shift_randomness::NO_RANDOM, shift_randomness::RANDOM}) {
+			QCMatrix qc{make_qc_matrix(bg, Z, BG_type::BG2, rnd, engine)};
+			CycleStats lifted{count_cycles(BinarySparseMatrix{qc.to_sparse()})};
+			CycleStats base{count_cycles(qc, 4)};
+			CHECK( base.girth == lifted.girth );
+			CHECK( base.cycles_4 == lifted.cycles_4 );
+			CHECK( base.cycles_6 == lifted.cycles_6 );
+			CHECK( base.cycles_8 == lifted.cycles_8 );
+		}
+	}
+}
+
+TEST_CASE("cycles of BG1 lifted with the largest Z are counted from the base graph") {
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> bg{load_matrix_from_alist(CMAKE_BINARY_DIR + std::string("/src/coding/data/BG1.alist"))};
+	QCMatrix qc{make_qc_matrix(bg, 384, BG_type::BG1)};
+
+	auto start{std::chrono::steady_clock::now()};
+	CycleStats single{count_cycles(qc)};
+	auto counted{std::chrono::steady_clock::now()};
+	CycleStats parallel{count_cycles(qc, 4)};
+	auto counted_parallel{std::chrono::steady_clock::now()};
+	MESSAGE("BG1, Z = 384: girth " << single.girth << ", " << single.cycles_4 << " 4-cycles, " << single.cycles_6 << " 6-cycles, "
+		<< single.cycles_8 << " 8-cycles in " << std::chrono::duration<double, std::milli>(counted - start).count() << " ms, "
+		<< std::chrono::duration<double, std::milli>(counted_parallel - counted).count() << " ms on 4 threads");
+	CHECK( parallel.girth == single.girth );
+	CHECK( parallel.cycles_4 == single.cycles_4 );
+	CHECK( parallel.cycles_6 == single.cycles_6 );
+	CHECK( parallel.cycles_8 == single.cycles_8 );
+	CHECK( single.cycles_4 % 384 == 0 );
+	CHECK( single.cycles_6 % 384 == 0 );
+	CHECK( single.cycles_8 % 384 == 0 );
+}
@@ -6,6 +6,7 @@
 #include <fstream>
 #include <random>
 #include <stdexcept>
+#include <thread>
 
 using namespace benchmarks;
 std::pair<double, double>
@@ -110,3 +111,86 @@ TEST_CASE("BG1: MockWynersEC find_intersection comparison with run method") {
 	}
 }
 
+
+TEST_CASE("perform_error_correction works on a benchmark that has not run yet") {
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> bg{vec_to_sparse_m({{1, 1, 1, 1, 0, 0, 1, 0, 0, 1, 1, 1, 0, 0},
+	                                                              {1, 0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 0},
+	                                                              {1, 1, 0, 1, 1, 0, 0, 0, 1, 0, 1, 0, 1, 1},
+	                                                              {0, 1, 1, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 1},})};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(bg, 16, BG_type::BG2).to_sparse()};
+	MemoryManager mm{H, BaseBenchmark::THREADS_NUMBER};
+	for (LDPC_algo alg_type : {LDPC_algo::NMS, LDPC_algo::SP}) {
+		BSChannellWynersEC wynersEC{H};
+		CHECK_NOTHROW( wynersEC.perform_error_correction(0.01, alg_type, mm, 2) );
+		CHECK_THROWS_AS( wynersEC.perform_error_correction(0.01, alg_type, mm, BaseBenchmark::THREADS_NUMBER), std::runtime_error );
+	}
+
+	// Threads decode on the context built with the benchmark, none of them replaces it
+	BSChannellWynersEC wynersEC{H};
+	std::vector<std::thread> threads;
+	for (size_t thread_index{BaseBenchmark::THREADS_NUMBER}; thread_index-- > 0; ) {
+		threads.emplace_back([&wynersEC, &mm, thread_index]() {
+			for (size_t frame{0}; frame < 5; ++frame) {
+				wynersEC.perform_error_correction(0.01, LDPC_algo::SP, mm, thread_index);
+			}
+		});
+	}
+	for (std::thread & thread : threads) {
+		thread.join();
+	}
+}
+
+TEST_CASE("batch error correction checks frames against packed syndromes") {
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> bg{vec_to_sparse_m({{1, 1, 1, 1, 0, 0, 1, 0, 0, 1, 1, 1, 0, 0},
+	                                                              {1, 0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 0},
+	                                                              {1, 1, 0, 1, 1, 0, 0, 0, 1, 0, 1, 0, 1, 1},
+	                                                              {0, 1, 1, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 1},})};
+	BSChannellWynersEC wynersEC{make_qc_matrix(bg, 16, BG_type::BG2).to_sparse()};
+	CHECK( wynersEC.perform_error_correction_batch(0.0, LDPC_algo::NMS, 20) == 20 );
+	CHECK( wynersEC.perform_error_correction_batch(0.01, LDPC_algo::NMS, 20) >= 15 );
+}
+
+TEST_CASE("reconcile refuses a warm-started fallback of another message precision") {
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> bg{vec_to_sparse_m({{1, 1, 1, 1, 0, 0, 1, 0, 0, 1, 1, 1, 0, 0},
+	                                                              {1, 0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 0},
+	                                                              {1, 1, 0, 1, 1, 0, 0, 0, 1, 0, 1, 0, 1, 1},
+	                                                              {0, 1, 1, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 1},})};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(bg, 16, BG_type::BG2).to_sparse()};
+	DecoderContext ctx{H, 1};
+	std::vector<LLR> llrs(H.cols(), 1.0);
+	BitVector out(H.cols());
+
+	DecoderParams first;
+	first.precision = MessagePrecision::FLOAT;
+	DecoderParams fallback;
+	fallback.warm_start = true;
+	DecoderChain chain{{LDPC_algo::NMS, first}, DecoderStage{LDPC_algo::SP, fallback}};
+	CHECK_THROWS_AS( reconcile(ctx, 0, chain, llrs, BitVector(H.rows()), out), std::runtime_error );
+
+	chain.fallback->params.precision = MessagePrecision::FLOAT;
+	CHECK_NOTHROW( reconcile(ctx, 0, chain, llrs, BitVector(H.rows()), out) );
+}
+
+TEST_CASE("decoder chains of a benchmark follow its params and fallback") {
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> bg{vec_to_sparse_m({{1, 1, 1, 1, 0, 0, 1, 0, 0, 1, 1, 1, 0, 0},
+	                                                              {1, 0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 0},
+	                                                              {1, 1, 0, 1, 1, 0, 0, 0, 1, 0, 1, 0, 1, 1},
+	                                                              {0, 1, 1, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 1},})};
+	Eigen::SparseMatrix<GF2, Eigen::RowMajor> H{make_qc_matrix(bg, 16, BG_type::BG2).to_sparse()};
+	MemoryManager mm{H, 1};
+	BSChannellWynersEC wynersEC{H};
+	DecoderChain const& chain{wynersEC.decoder_chain(LDPC_algo::LNMS)};
+	CHECK( chain.first.alg_type == LDPC_algo::LNMS );
+	CHECK( !chain.fallback );
+
+	DecoderParams params;
+	params.layer_size = 16;
+	params.scale_by_iteration = {1.0, 0.875, 0.75};
+	wynersEC.set_decoder_params(params);
+	wynersEC.set_fallback_decoder(DecoderStage{LDPC_algo::SP, params});
+	CHECK( &wynersEC.decoder_chain(LDPC_algo::LNMS) == &chain );
+	CHECK( chain.first.params.scale_by_iteration == params.scale_by_iteration );
+	REQUIRE( chain.fallback );
+	CHECK( chain.fallback->alg_type == LDPC_algo::SP );
+	CHECK( wynersEC.perform_error_correction(0.0, LDPC_algo::LNMS, mm, 0) );
+}